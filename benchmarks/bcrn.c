@@ -0,0 +1,203 @@
+/*
+ *      Filename: bcrn.c
+ *   Description: Report comparing two protocols on common random numbers. Reads two protocols in
+ *                the input format of popsimio with the same states, scales the initial
+ *                configuration of either one to nagents agents and runs both protocols nruns times
+ *                for nsteps interactions, once coupled by popsim_crn and once independently by
+ *                popsim_batch. For every state, the means of the final counts of either
+ *                protocol, the mean of their paired difference with its 95% confidence interval
+ *                and the standard deviations of the difference with and without coupling are
+ *                printed together with the variance reduction and the wall time per pair of runs.
+ *                Usage: bcrn nagents nsteps nruns protocol1 protocol2
+ *   Assumptions: The protocols have few states, such that delta fits into an array.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "popsim.h"
+#include "linurn.h"
+#include "trtab.h"
+#include "snap.h"
+
+typedef unsigned long long ullong;
+typedef long double ldouble;
+
+ullong  nstates;
+ullong* dfst[2];
+ullong* dscd[2];
+
+void delta0(ullong p, ullong q, ullong* pn, ullong* qn) {
+    *pn = dfst[0][p*nstates+q];
+    *qn = dscd[0][p*nstates+q];
+}
+
+void delta1(ullong p, ullong q, ullong* pn, ullong* qn) {
+    *pn = dfst[1][p*nstates+q];
+    *qn = dscd[1][p*nstates+q];
+}
+
+double wall(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+/*
+ *  Reads the protocol a from the file name into dfst[a], dscd[a] and the returned transition
+ *  table, where the initial configuration is scaled to nagents agents in dist. Returns NULL if the
+ *  file could not be read or its number of states differs from nstates, which is set by the first
+ *  protocol.
+ */
+trtab_t* readproto(const char* name, ullong a, ullong nagents, ullong** dist) {
+    FILE* f = fopen(name, "r");
+    if(f == NULL)
+        return NULL;
+
+    ullong ns, ndist, ntrans, s, q, k1, k2, v1, v2;
+    if(fscanf(f, "%llu %llu %llu", &ns, &ndist, &ntrans) != 3 || (a > 0 && ns != nstates)) {
+        fclose(f);
+        return NULL;
+    }
+    nstates = ns;
+
+    // The initial configuration keeps its proportions
+    ldouble* frac = (ldouble*) calloc(nstates, sizeof(ldouble));
+    ldouble total = 0.L;
+    for(ullong i = 0; i < ndist && fscanf(f, " %llu:%llu", &s, &q) == 2; ++i) {
+        frac[s-1] += q;
+        total     += q;
+    }
+    ullong n = 0;
+    dist[a] = (ullong*) calloc(nstates, sizeof(ullong));
+    for(s = 0; s < nstates; ++s)
+        n += dist[a][s] = (ullong) (nagents * frac[s] / total);
+    for(s = 0; n < nagents; s = (s+1) % nstates)
+        if(frac[s] > 0.L) { dist[a][s]++; n++; }
+    free(frac);
+
+    dfst[a] = (ullong*) malloc(nstates*nstates * sizeof(ullong));
+    dscd[a] = (ullong*) malloc(nstates*nstates * sizeof(ullong));
+    for(ullong p = 0; p < nstates*nstates; ++p) {
+        dfst[a][p] = p / nstates;
+        dscd[a][p] = p % nstates;
+    }
+    trtab_t* tr = trtab_create(nstates, ntrans);
+    for(ullong i = 0; i < ntrans && fscanf(f, " %llu:%llu %llu:%llu", &k1, &k2, &v1, &v2) == 4;
+        ++i) {
+        dfst[a][(k1-1)*nstates+k2-1] = v1-1;
+        dscd[a][(k1-1)*nstates+k2-1] = v2-1;
+        trtab_insert(tr, k1-1, k2-1, v1-1, v2-1);
+    }
+    trtab_build(tr);
+    fclose(f);
+    return tr;
+}
+
+/*
+ *  Runs nruns pairs of simulations of nsteps interactions from dist, either coupled or
+ *  independent, and accumulates the sums of the final counts of either protocol and the sums and
+ *  squared sums of their differences. Returns the wall time per pair.
+ */
+double run(ullong** dist, ullong nsteps, ullong nruns, snap_t* snap, trtab_t** tr, int coupled,
+           ldouble* sum, ldouble* dsum, ldouble* dsq) {
+    void (*delta[2])(ullong, ullong, ullong*, ullong*) = {delta0, delta1};
+    ullong* conf[2];
+    linurn_t* u[2];
+    for(ullong a = 0; a < 2; ++a)
+        conf[a] = (ullong*) malloc(2*nstates * sizeof(ullong));
+
+    double start = wall();
+    for(ullong r = 0; r < nruns; ++r) {
+        int ok = 1;
+        for(ullong a = 0; a < 2; ++a) {
+            u[a] = linurn_create(2*r+a+1, nstates);
+            linurn_insert(u[a], dist[a]);
+        }
+        if(coupled) {
+            ok = popsim_crn(u, nsteps, nstates, snap, conf, delta, tr, NULL,
+                            3*r+1, 5*r+2, 7*r+3);
+        } else {
+            for(ullong a = 0; a < 2 && ok; ++a)
+                ok = popsim_batch(u[a], nsteps, nstates, snap, conf[a], delta[a], tr[a], NULL,
+                                  NULL, 3*r+a+1, 5*r+a+2, 7*r+a+3);
+        }
+        if(ok == 0) {
+            fprintf(stderr, "Simulation failed.\n");
+            abort();
+        }
+
+        for(ullong s = 0; s < nstates; ++s) {
+            ldouble d = (ldouble) conf[1][nstates+s] - (ldouble) conf[0][nstates+s];
+            sum[s]         += conf[0][nstates+s];
+            sum[nstates+s] += conf[1][nstates+s];
+            dsum[s] += d;
+            dsq[s]  += d*d;
+        }
+        for(ullong a = 0; a < 2; ++a)
+            linurn_destroy(u[a]);
+    }
+    double end = wall();
+
+    for(ullong a = 0; a < 2; ++a)
+        free(conf[a]);
+    return (end-start) / nruns;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 6) {
+        fprintf(stderr, "Usage: %s nagents nsteps nruns protocol1 protocol2\n", argv[0]);
+        return -1;
+    }
+    ullong nagents = strtoull(argv[1], NULL, 10);
+    ullong nsteps  = strtoull(argv[2], NULL, 10);
+    ullong nruns   = strtoull(argv[3], NULL, 10);
+    if(nruns < 2 || nsteps < 1)
+        return -1;
+
+    ullong*  dist[2];
+    trtab_t* tr[2];
+    for(ullong a = 0; a < 2; ++a) {
+        if((tr[a] = readproto(argv[4+a], a, nagents, dist)) == NULL) {
+            fprintf(stderr, "Could not read protocol %s.\n", argv[4+a]);
+            return -1;
+        }
+    }
+
+    snap_t* snap = snap_equi(nsteps, 1);
+    ldouble* csum  = (ldouble*) calloc(2*nstates, sizeof(ldouble));
+    ldouble* isum  = (ldouble*) calloc(2*nstates, sizeof(ldouble));
+    ldouble* cdsum = (ldouble*) calloc(nstates, sizeof(ldouble));
+    ldouble* cdsq  = (ldouble*) calloc(nstates, sizeof(ldouble));
+    ldouble* idsum = (ldouble*) calloc(nstates, sizeof(ldouble));
+    ldouble* idsq  = (ldouble*) calloc(nstates, sizeof(ldouble));
+
+    double ctime = run(dist, nsteps, nruns, snap, tr, 1, csum, cdsum, cdsq);
+    double itime = run(dist, nsteps, nruns, snap, tr, 0, isum, idsum, idsq);
+
+    printf("%-6s %12s %12s %12s %12s %12s %12s %10s\n", "state", "mean 1", "mean 2", "diff",
+           "+-95%", "sd crn", "sd indep", "var red");
+    for(ullong s = 0; s < nstates; ++s) {
+        ldouble cm = cdsum[s]/nruns, im = idsum[s]/nruns;
+        ldouble cv = (cdsq[s] - nruns*cm*cm) / (nruns-1);
+        ldouble iv = (idsq[s] - nruns*im*im) / (nruns-1);
+        cv = (cv > 0.L) ? cv : 0.L;
+        iv = (iv > 0.L) ? iv : 0.L;
+        printf("%-6llu %12.2Lf %12.2Lf %12.2Lf %12.2Lf %12.2Lf %12.2Lf %10.2Lf\n", s+1,
+               csum[s]/nruns, csum[nstates+s]/nruns, cm, 1.96L*sqrtl(cv/nruns), sqrtl(cv),
+               sqrtl(iv), cv > 0.L ? iv/cv : INFINITY);
+    }
+    printf("s/pair crn %.4f indep %.4f\n", ctime, itime);
+
+    free(csum); free(isum); free(cdsum); free(cdsq); free(idsum); free(idsq);
+    for(ullong a = 0; a < 2; ++a) {
+        free(dfst[a]); free(dscd[a]); free(dist[a]);
+        trtab_destroy(tr[a]);
+    }
+    snap_destroy(snap);
+    return 0;
+}
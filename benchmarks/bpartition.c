@@ -0,0 +1,167 @@
+/*
+ *      Filename: bpartition.c
+ *   Description: Report comparing the trajectories of the approximate partitioned simulator with
+ *                the exact multi batched simulator. Reads a protocol in the input format of
+ *                popsimio from stdin, scales its initial configuration to nagents agents and runs
+ *                both simulators nruns times for nsteps interactions. For every number of
+ *                partitions and reshuffle period, the largest z-score of the difference of the
+ *                mean state counts over all snapshots and states, the mean ratio of the standard
+ *                deviations of the final state counts and the wall time per run are printed.
+ *                Usage: bpartition nagents nsteps nruns < protocol
+ *   Assumptions: The protocol has few states, such that delta fits into an array.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#include "popsim.h"
+#include "bsturn.h"
+#include "trtab.h"
+#include "snap.h"
+
+#define NSNAP 10
+
+typedef unsigned long long ullong;
+typedef long double ldouble;
+
+ullong  nstates;
+ullong* dfst;
+ullong* dscd;
+
+void delta(ullong p, ullong q, ullong* pn, ullong* qn) {
+    *pn = dfst[p*nstates+q];
+    *qn = dscd[p*nstates+q];
+}
+
+double wall(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+/*
+ *  Runs nruns simulations of nsteps interactions from dist, where nparts == 0 selects the exact
+ *  simulator, and accumulates the sums and squared sums of every snapshot count. Returns the wall
+ *  time per run.
+ */
+double run(ullong* dist, ullong nsteps, ullong nruns, snap_t* snap, trtab_t* tr, ullong nparts,
+           ldouble period, ldouble* sum, ldouble* sqsum) {
+    ullong nconf = NSNAP+1;
+    ullong* conf = (ullong*) malloc(nconf*nstates * sizeof(ullong));
+    popsim_epoch_t ep;
+    double start = wall();
+    for(ullong r = 0; r < nruns; ++r) {
+        bsturn_t* u = bsturn_create(2*r+1, nstates);
+        bsturn_insert(u, dist);
+        popsim_epoch_model(&ep, nstates, bsturn_nmarbles(u));
+        int ok = (nparts == 0) ?
+                popsim_mbatch(u, nsteps, nstates, snap, conf, delta, tr, NULL, NULL, &ep,
+                              3*r+1, 5*r+2, 7*r+3) :
+                popsim_partition(u, nsteps, nstates, snap, conf, delta, tr, NULL, nparts, period,
+                                 3*r+1, 5*r+2, 7*r+3);
+        if(ok == 0) {
+            fprintf(stderr, "Simulation failed.\n");
+            abort();
+        }
+        for(ullong i = 0; i < nconf*nstates; ++i) {
+            sum[i]   += conf[i];
+            sqsum[i] += (ldouble) conf[i] * conf[i];
+        }
+        bsturn_destroy(u);
+    }
+    double end = wall();
+    free(conf);
+    return (end-start) / nruns;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 4) {
+        fprintf(stderr, "Usage: %s nagents nsteps nruns < protocol\n", argv[0]);
+        return -1;
+    }
+    ullong nagents = strtoull(argv[1], NULL, 10);
+    ullong nsteps  = strtoull(argv[2], NULL, 10);
+    ullong nruns   = strtoull(argv[3], NULL, 10);
+
+    ullong ndist, ntrans, s, q, k1, k2, v1, v2;
+    if(scanf("%llu %llu %llu", &nstates, &ndist, &ntrans) != 3 || nruns < 2 || nsteps < NSNAP)
+        return -1;
+
+    // The initial configuration keeps its proportions
+    ldouble* frac = (ldouble*) calloc(nstates, sizeof(ldouble));
+    ullong*  dist = (ullong*)  calloc(nstates, sizeof(ullong));
+    ldouble total = 0.L;
+    for(ullong i = 0; i < ndist && scanf(" %llu:%llu", &s, &q) == 2; ++i) {
+        frac[s-1] += q;
+        total     += q;
+    }
+    ullong n = 0;
+    for(s = 0; s < nstates; ++s)
+        n += dist[s] = (ullong) (nagents * frac[s] / total);
+    for(s = 0; n < nagents; s = (s+1) % nstates)
+        if(frac[s] > 0.L) { dist[s]++; n++; }
+
+    dfst = (ullong*) malloc(nstates*nstates * sizeof(ullong));
+    dscd = (ullong*) malloc(nstates*nstates * sizeof(ullong));
+    for(ullong p = 0; p < nstates*nstates; ++p) {
+        dfst[p] = p / nstates;
+        dscd[p] = p % nstates;
+    }
+    trtab_t* tr = trtab_create(nstates, ntrans);
+    for(ullong i = 0; i < ntrans && scanf(" %llu:%llu %llu:%llu", &k1, &k2, &v1, &v2) == 4; ++i) {
+        dfst[(k1-1)*nstates+k2-1] = v1-1;
+        dscd[(k1-1)*nstates+k2-1] = v2-1;
+        trtab_insert(tr, k1-1, k2-1, v1-1, v2-1);
+    }
+    trtab_build(tr);
+
+    snap_t* snap = snap_equi(nsteps, NSNAP);
+    ullong size = (NSNAP+1)*nstates;
+    ldouble* esum = (ldouble*) calloc(size, sizeof(ldouble));
+    ldouble* esq  = (ldouble*) calloc(size, sizeof(ldouble));
+    ldouble* psum = (ldouble*) malloc(size * sizeof(ldouble));
+    ldouble* psq  = (ldouble*) malloc(size * sizeof(ldouble));
+
+    double etime = run(dist, nsteps, nruns, snap, tr, 0, 0.L, esum, esq);
+    printf("%-10s %-8s %10s %10s %12s\n", "nparts", "period", "max|z|", "sd ratio", "s/run");
+    printf("%-10s %-8s %10s %10s %12.4f\n", "exact", "-", "-", "-", etime);
+
+    ullong  parts[]   = {2, 4, 8};
+    ldouble periods[] = {0.1L, 1.L, 10.L};
+    for(ullong a = 0; a < sizeof(parts)/sizeof(parts[0]); ++a) {
+        for(ullong b = 0; b < sizeof(periods)/sizeof(periods[0]); ++b) {
+            for(ullong i = 0; i < size; ++i)
+                psum[i] = psq[i] = 0.L;
+            double ptime = run(dist, nsteps, nruns, snap, tr, parts[a], periods[b], psum, psq);
+
+            // Welch z-score of the means per snapshot and state, where constant counts are skipped
+            ldouble zmax = 0.L, ratio = 0.L;
+            ullong nratio = 0;
+            for(ullong i = 0; i < size; ++i) {
+                ldouble em = esum[i]/nruns, pm = psum[i]/nruns;
+                ldouble ev = (esq[i] - nruns*em*em) / (nruns-1);
+                ldouble pv = (psq[i] - nruns*pm*pm) / (nruns-1);
+                ev = (ev > 0.L) ? ev : 0.L;
+                pv = (pv > 0.L) ? pv : 0.L;
+                if(ev + pv > 0.L && fabsl(pm-em) / sqrtl((ev+pv)/nruns) > zmax)
+                    zmax = fabsl(pm-em) / sqrtl((ev+pv)/nruns);
+                if(i >= NSNAP*nstates && ev > 0.L) {
+                    ratio += sqrtl(pv/ev);
+                    nratio++;
+                }
+            }
+            printf("%-10llu %-8.1Lf %10.2Lf %10.3Lf %12.4f\n", parts[a], periods[b], zmax,
+                   nratio > 0 ? ratio/nratio : 1.L, ptime);
+        }
+    }
+
+    free(esum); free(esq); free(psum); free(psq);
+    free(frac); free(dist); free(dfst); free(dscd);
+    snap_destroy(snap);
+    trtab_destroy(tr);
+    return 0;
+}
@@ -96,6 +96,69 @@ static inline ullong bsturn_draw(bsturn_t* u) {
     return node-u->cstart;
 }
 
+/*
+ *   Description: Draws a marble without replacement from each of the n urns in us at once and
+ *                writes its color to cs. The descents through the trees are interleaved level
+ *                by level without branches and the children of every visited node are
+ *                prefetched, such that the cache misses of different urns overlap instead of
+ *                forming one dependent chain per urn. The result is the same as of bsturn_draw on
+ *                every urn in turn.
+ *   Assumptions: All urns have the same number of colors and none of them is empty, n is at most
+ *                BSTURN_MAXDRAW and cs holds at least n members.
+ */
+#define BSTURN_MAXDRAW 16
+
+static inline void bsturn_mdraw(bsturn_t** us, ullong n, ullong* cs) {
+    ullong marble[BSTURN_MAXDRAW];
+    for(ullong r = 0; r < n; ++r) {
+        marble[r] = mt_urand(&(us[r]->mt), us[r]->nmarbles);
+        cs[r]     = ROOT;
+        __builtin_prefetch(us[r]->bst + ROOT, 1);
+    }
+
+    for(ullong lvl = 0; lvl < us[0]->height; ++lvl) {
+        for(ullong r = 0; r < n; ++r) {
+            ullong* bst = us[r]->bst;
+            ullong  v   = bst[cs[r]];
+            ullong  rgt = (marble[r] >= v);
+            bst[cs[r]] -= 1-rgt;
+            marble[r]  -= rgt*v;
+            cs[r]       = LCHILD(cs[r]) + rgt;
+            // Both children share a cache line since LCHILD(node) is even
+            __builtin_prefetch(bst + LCHILD(cs[r]), 1);
+        }
+    }
+
+    for(ullong r = 0; r < n; ++r) {
+        us[r]->nmarbles--;
+        us[r]->bst[cs[r]]--;
+        cs[r] -= us[r]->cstart;
+    }
+}
+
+/*
+ *   Description: Inserts a marble of color cs[r] into the urn us[r] for each of the n urns at once,
+ *                where the ascents through the trees are interleaved level by level.
+ *   Assumptions: All urns have the same number of colors, cs[r] < ncolors and n is at most
+ *                BSTURN_MAXDRAW.
+ */
+static inline void bsturn_minsert(bsturn_t** us, ullong n, ullong* cs) {
+    ullong node[BSTURN_MAXDRAW];
+    for(ullong r = 0; r < n; ++r) {
+        node[r] = us[r]->cstart + cs[r];
+        us[r]->bst[node[r]]++;
+        us[r]->nmarbles++;
+    }
+
+    // A node adds its marble to its parent only as the left child
+    for(ullong lvl = 0; lvl < us[0]->height; ++lvl) {
+        for(ullong r = 0; r < n; ++r) {
+            us[r]->bst[node[r] >> 1] += 1 - (node[r] & 1);
+            node[r] >>= 1;
+        }
+    }
+}
+
 /*
  *   Description: Inserts marbles of color c into the urn
  *   Assumptions: c < ncolors and there is enough space in the urn.
@@ -0,0 +1,129 @@
+/*
+ *      Filename: crn.h
+ *   Description: Chemical reaction networks of unimolecular and bimolecular reactions with rate
+ *                constants, which are simulated exactly in continuous time by the stochastic
+ *                simulation algorithm. A reaction has at most two reactants and at most two
+ *                products, absent ones are given as CRN_NONE. The propensity of a reaction with
+ *                rate k in a volume vol is k*vol without reactants, k*x with a single reactant,
+ *                k*x*y/vol with two distinct reactants and k*x*(x-1)/(2*vol) with two reactants of
+ *                the same species, where x and y are the reactant counts. A population protocol
+ *                is the special case of bimolecular reactions with rate 1.
+ *                Two simulators are offered: the direct method by D. T. Gillespie. Exact
+ *                Stochastic Simulation of Coupled Chemical Reactions. 1977. and the next reaction
+ *                method by M. A. Gibson and J. Bruck. Efficient Exact Stochastic Simulation of
+ *                Chemical Systems with Many Species and Many Channels. 2000. Both only update the
+ *                propensities of the reactions in the dependency graph of the fired reaction.
+ *   Assumptions: The network needs to be created before and destroyed after use, all reactions
+ *                need to be inserted before it is built and species are represented as integers
+ *                in [0,nspecies).
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#ifndef CRN_H
+#define CRN_H
+
+#include "linurn.h"
+#include "snap.h"
+
+#include <limits.h>
+
+#define CRN_NONE ULLONG_MAX
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+typedef struct reac_t {
+    ullong  r[2];
+    ullong  p[2];
+    ldouble rate;
+} reac_t;
+
+// Should be treated as opaque.
+typedef struct crn_t {
+    ullong  nspecies;
+    ullong  nreac;
+    ullong  max_nreac;
+    ldouble vol;
+
+    reac_t* reac;
+    ullong* sstart;
+    ullong* sidx;
+    ullong* dstart;
+    ullong* didx;
+} crn_t;
+
+/*
+ *   Description: Initializes and allocates a new network of at most max_nreac reactions in the
+ *                volume vol.
+ *  Return value: A pointer to the network or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the network and EDOM if
+ *                nspecies == ULLONG_MAX or vol is not positive.
+ */
+crn_t* crn_create(ullong nspecies, ullong max_nreac, ldouble vol);
+
+/*
+ *   Description: Inserts the reaction r1 + r2 -> p1 + p2 with the rate constant rate into the
+ *                network, where any of the species may be CRN_NONE.
+ *  Return value: Zero if the network was already full and non-zero otherwise.
+ *   Assumptions: The network is not built yet and rate >= 0.
+ */
+int crn_insert(crn_t* c, ullong r1, ullong r2, ullong p1, ullong p2, ldouble rate);
+
+/*
+ *   Description: Builds the species to reaction index and the dependency graph, which holds for
+ *                every reaction the reactions whose propensities change when it fires.
+ *  Return value: Zero if there was not enough memory and non-zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the dependency graph.
+ */
+int crn_build(crn_t* c);
+
+/*
+ *   Description: Getter function for the propensity of the i-th reaction given the species counts
+ *                dist.
+ *   Assumptions: i < nreac.
+ */
+static inline ldouble crn_prop(crn_t* c, ullong i, ullong* dist) {
+    reac_t* re = c->reac + i;
+    if(re->r[0] == CRN_NONE)
+        return re->rate * c->vol;
+    if(re->r[1] == CRN_NONE)
+        return re->rate * dist[re->r[0]];
+    if(re->r[0] != re->r[1])
+        return re->rate * dist[re->r[0]] * (ldouble) dist[re->r[1]] / c->vol;
+    return re->rate * dist[re->r[0]] * (ldouble) (dist[re->r[0]] - (dist[re->r[0]] > 0)) /
+           (2.L * c->vol);
+}
+
+/*
+ *   Description: Simulates the network by the direct method until the time of the last snapshot
+ *                of the continuous time schedule snap. The species counts are kept as the colors
+ *                of the urn u and conf holds the initial configuration followed by the
+ *                configurations at the times of the schedule, where each snapshot holds the
+ *                configuration after the last reaction at or before its time. If no reaction can
+ *                fire anymore, the remaining snapshots are filled with the final configuration.
+ *  Return value: The number of fired reactions or ULLONG_MAX on error.
+ *        Errors: ENOMEM if there was not enough memory for the propensities.
+ *   Assumptions: The network is built, u holds nspecies colors, snap is a continuous time schedule
+ *                and conf has space for (snap_nsnap(snap)+1)*nspecies elements.
+ */
+ullong crn_direct(crn_t* c, linurn_t* u, snap_t* snap, ullong* conf, ullong seed);
+
+/*
+ *   Description: Simulates the network by the next reaction method, which keeps the putative
+ *                firing times of all reactions in an indexed binary heap such that each fired
+ *                reaction costs O(log R) per dependent reaction. The parameters and the snapshots
+ *                are as for crn_direct.
+ *  Return value: The number of fired reactions or ULLONG_MAX on error.
+ *        Errors: ENOMEM if there was not enough memory for the heap.
+ *   Assumptions: See crn_direct.
+ */
+ullong crn_nextreaction(crn_t* c, linurn_t* u, snap_t* snap, ullong* conf, ullong seed);
+
+/*
+ *   Description: Frees the network structure and all other pointers allocated by the create
+ *                function.
+ */
+void crn_destroy(crn_t* c);
+
+#endif
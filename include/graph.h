@@ -0,0 +1,121 @@
+/*
+ *      Filename: graph.h
+ *   Description: Undirected interaction graph of a population, where agents are the vertices and
+ *                only agents joined by an edge interact. After being built, the graph keeps its
+ *                edges as a flat array of vertex pairs, such that a uniform edge is drawn in O(1),
+ *                and its adjacency in compressed sparse row format. Vertices are stored as
+ *                unsigned ints to halve the memory traffic of large graphs.
+ *   Assumptions: The graph needs to be created before and destroyed after use, all edges need to
+ *                be inserted before it is built and vertices are represented as integers in
+ *                [0,nvert).
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include "mt.h"
+
+typedef unsigned int       uint;
+typedef unsigned long long ullong;
+
+// Should be treated as opaque.
+typedef struct graph_t {
+    ullong nvert;
+    ullong nedges;
+    ullong max_nedges;
+
+    uint*   edge;
+    ullong* rstart;
+    uint*   adj;
+} graph_t;
+
+/*
+ *   Description: Initializes and allocates a new graph of nvert vertices and at most max_nedges
+ *                edges.
+ *  Return value: A pointer to the graph or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the graph and EDOM if
+ *                nvert >= UINT_MAX.
+ */
+graph_t* graph_create(ullong nvert, ullong max_nedges);
+
+/*
+ *   Description: Inserts the edge {v,w} into the graph unless it is a self loop.
+ *  Return value: Zero if the graph was already full and non-zero otherwise.
+ *   Assumptions: max(v,w) < nvert and the graph is not built yet.
+ */
+int graph_insert(graph_t* g, ullong v, ullong w);
+
+/*
+ *   Description: Builds the adjacency of the inserted edges in compressed sparse row format.
+ *  Return value: Zero if there was not enough memory and non-zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the adjacency.
+ */
+int graph_build(graph_t* g);
+
+/*
+ *   Description: Relabels the vertices in breadth first order starting from a vertex of minimum
+ *                degree in every component, in the spirit of the Cuthill-McKee ordering, and sorts
+ *                the edges by their smaller endpoint. Afterwards, the endpoints of most edges are
+ *                close to each other in memory, such that both states of an interaction tend to
+ *                share a cache line or page.
+ *  Return value: Zero if there was not enough memory and non-zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the permutation.
+ *   Assumptions: The graph was built and it is rebuilt in the process.
+ */
+int graph_reorder(graph_t* g);
+
+/*
+ *   Description: Creates and builds the ring, the rows x cols torus grid or a random d-regular
+ *                multigraph of the configuration model, where self loops are dropped.
+ *  Return value: A pointer to the graph or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the graph and EDOM if the graph would
+ *                have less than two vertices, nvert >= UINT_MAX or nvert*d is odd.
+ */
+graph_t* graph_ring(ullong nvert);
+graph_t* graph_grid(ullong rows, ullong cols);
+graph_t* graph_rrg(ullong nvert, ullong d, ullong seed);
+
+/*
+ *   Description: Draws a uniform edge in a uniform orientation, where v is the initiator and w
+ *                the responder.
+ *   Assumptions: The graph was built and has at least one edge.
+ */
+static inline void graph_draw(graph_t* g, mt_t* mt, ullong* v, ullong* w) {
+    ullong a = mt_urand(mt, 2*g->nedges);
+    *v = g->edge[a];
+    *w = g->edge[a^1];
+}
+
+/*
+ *   Description: Getter functions for the neighbours of v, which are given by the vertices in
+ *                [graph_nbegin(g,v),graph_nend(g,v)).
+ *   Assumptions: The graph was built and v < nvert.
+ */
+static inline uint* graph_nbegin(graph_t* g, ullong v) {
+    return g->adj + g->rstart[v];
+}
+
+static inline uint* graph_nend(graph_t* g, ullong v) {
+    return g->adj + g->rstart[v+1];
+}
+
+/*
+ *   Description: Getter functions for the number of vertices and edges.
+ */
+static inline ullong graph_nvert(graph_t* g) {
+    return g->nvert;
+}
+
+static inline ullong graph_nedges(graph_t* g) {
+    return g->nedges;
+}
+
+/*
+ *   Description: Frees the graph structure and all other pointers allocated by the create
+ *                function.
+ */
+void graph_destroy(graph_t* g);
+
+#endif
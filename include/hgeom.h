@@ -1,8 +1,8 @@
 /*
  *      Filename: hgeom.h
- *   Description: Sampling from the (multivariate) hypergeometric distribution. The code for mhgeom
- *                was written by Niklas Mamtschur whereas the rest of the code was taken from
- *                NumPy.
+ *   Description: Sampling from the (multivariate) hypergeometric distribution and the binomial
+ *                and multinomial distribution. The code for mhgeom, mhgeom_pairs, binom and mbinom
+ *                was written by Niklas Mamtschur whereas the rest of the code was taken from NumPy.
  *   Assumptions: The mt state needs to be initialized before being passed and the number of good
  *                marbles as well as the number of samples must be smaller than the total.
  *    Changed by: Niklas Mamtschur
@@ -15,6 +15,7 @@
 #include "mt.h"
 
 typedef unsigned long long ullong;
+typedef long double        ldouble;
 
 /*
  *  Description: Samples from the hypergeometric distribution.
@@ -31,4 +32,42 @@ ullong hgeom(mt_t* mt, ullong total, ullong good, ullong sample);
 void mhgeom(mt_t* mt, ullong* destdist, ullong* srcdist,
             ullong ncolors, ullong total, ullong sample);
 
+/*
+ *  Description: Samples from the binomial distribution of n trials with success probability p by
+ *               inversion for n*min(p,1-p) < 10 and by the BTRD algorithm of W. Hörmann otherwise,
+ *               such that the expected cost is constant.
+ *  Assumptions: 0 <= p <= 1.
+ */
+ullong binom(mt_t* mt, ullong n, ldouble p);
+
+/*
+ *  Description: Samples from the multinomial distribution of n trials over ncolors colors with the
+ *               probabilities probs by a binomial per color, where probs == NULL means uniform.
+ *  Assumptions: destdist and probs must hold ncolors elements, ncolors >= 1 and the probabilities
+ *               must add up to one.
+ */
+void mbinom(mt_t* mt, ullong* destdist, ldouble* probs, ullong ncolors, ullong n);
+
+/*
+ *  Description: Samples the matrix of interacting pairs of a uniform random pairing of the rows
+ *               with the columns, i.e. x[i][j] is the number of the rows[i] marbles of row color i
+ *               paired with one of the cols[j] marbles of column color j. Both ranges of colors
+ *               are split recursively in halves, where the rows of the first half take an exact
+ *               multivariate hypergeometric share of the columns, which is itself sampled by
+ *               binary splitting of the columns. Empty colors and empty blocks are dropped right
+ *               away, such that the cost tracks the number of non-zero cells. Every non-zero cell
+ *               is passed to emit together with arg, where the cells of a row are passed at once
+ *               in increasing order of their columns. Given the share of the columns, both halves
+ *               are independent and can be sampled in parallel.
+ *  Assumptions: rows and cols hold nrows >= 1 and ncols >= 1 elements adding up to the same total,
+ *               they are not changed, and work holds mhgeom_pairs_work(nrows,ncols) elements.
+ */
+void mhgeom_pairs(mt_t* mt, ullong* rows, ullong nrows, ullong* cols, ullong ncols, ullong* work,
+                  void (*emit)(ullong i, ullong j, ullong x, void* arg), void* arg);
+
+/*
+ *  Description: Returns the number of elements of the workspace of mhgeom_pairs.
+ */
+ullong mhgeom_pairs_work(ullong nrows, ullong ncols);
+
 #endif
@@ -0,0 +1,133 @@
+/*
+ *      Filename: ktab.h
+ *   Description: Sparse transition table of a protocol with k-ary interactions, where k agents
+ *                interact at once and the ordered tuple of their states (s_1,...,s_k) is mapped to
+ *                a new tuple (t_1,...,t_k). Only the transitions that are not the identity are
+ *                kept. After being built, the transitions are sorted lexicographically by their
+ *                keys, such that all transitions sharing a prefix of the key form a contiguous
+ *                range which can be narrowed position by position.
+ *   Assumptions: The table needs to be created before and destroyed after use, all transitions
+ *                need to be inserted before it is built and states are represented as integers in
+ *                [0,nstates).
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#ifndef KTAB_H
+#define KTAB_H
+
+#include <stddef.h>
+
+// Maximum arity of the interactions, such that a tuple of states fits onto the stack
+#define KTAB_MAXK 16
+
+typedef unsigned long long ullong;
+
+// Should be treated as opaque.
+typedef struct ktab_t {
+    ullong nstates;
+    ullong k;
+    ullong ntrans;
+    ullong max_ntrans;
+
+    ullong* key;
+    ullong* val;
+} ktab_t;
+
+/*
+ *   Description: Initializes and allocates a new table of k-ary transitions for at most max_ntrans
+ *                transitions.
+ *  Return value: A pointer to the table or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the table and EDOM if
+ *                nstates == ULLONG_MAX or k is not in [2,KTAB_MAXK].
+ */
+ktab_t* ktab_create(ullong nstates, ullong k, ullong max_ntrans);
+
+/*
+ *   Description: Inserts the transition key->val of the k states in key and val into the table
+ *                unless it is the identity.
+ *  Return value: Zero if the table was already full and non-zero otherwise.
+ *   Assumptions: The table is not built yet.
+ */
+int ktab_insert(ktab_t* t, ullong* key, ullong* val);
+
+/*
+ *   Description: Sorts the inserted transitions lexicographically by their keys, where only the
+ *                first inserted transition of every key is kept.
+ *  Return value: Zero if there was not enough memory and non-zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the sort.
+ */
+int ktab_build(ktab_t* t);
+
+/*
+ *   Description: Getter functions for the key and the value of the i-th transition in the sorted
+ *                order, each given as an array of k states.
+ *   Assumptions: The table was built and i < ntrans.
+ */
+static inline ullong* ktab_key(ktab_t* t, ullong i) {
+    return t->key + i*t->k;
+}
+
+static inline ullong* ktab_val(ktab_t* t, ullong i) {
+    return t->val + i*t->k;
+}
+
+/*
+ *   Description: Getter functions for the arity and the number of active transitions.
+ */
+static inline ullong ktab_k(ktab_t* t) {
+    return t->k;
+}
+
+static inline ullong ktab_ntrans(ktab_t* t) {
+    return t->ntrans;
+}
+
+/*
+ *   Description: Narrows the range [*lo,*hi) of transitions whose keys share a prefix of length
+ *                pos to the transitions whose key additionally holds the state s at position pos.
+ *                The range is empty afterwards if there is no such transition.
+ *   Assumptions: The table was built and pos < k.
+ */
+static inline void ktab_narrow(ktab_t* t, ullong* lo, ullong* hi, ullong pos, ullong s) {
+    ullong a = *lo, b = *hi, mi;
+    while(a < b) {
+        mi = a + (b-a)/2;
+        if(t->key[mi*t->k + pos] < s) a = mi+1;
+        else                          b = mi;
+    }
+    *lo = a;
+    b   = *hi;
+    while(a < b) {
+        mi = a + (b-a)/2;
+        if(t->key[mi*t->k + pos] <= s) a = mi+1;
+        else                           b = mi;
+    }
+    *hi = a;
+}
+
+/*
+ *   Description: Looks up the transition of the k states in key.
+ *  Return value: The k states the key is mapped to or NULL if the transition is the identity.
+ *   Assumptions: The table was built.
+ */
+static inline ullong* ktab_lookup(ktab_t* t, ullong* key) {
+    ullong lo = 0, hi = t->ntrans;
+    for(ullong pos = 0; pos < t->k && lo < hi; ++pos)
+        ktab_narrow(t, &lo, &hi, pos, key[pos]);
+    return (lo < hi) ? ktab_val(t, lo) : NULL;
+}
+
+/*
+ *   Description: Checks whether the configuration dist is silent, i.e. no active transition of the
+ *                table applies to any k agents.
+ *  Return value: Non-zero if dist is silent and zero otherwise.
+ */
+int ktab_silent(ktab_t* t, ullong* dist);
+
+/*
+ *   Description: Frees the memory kept by the table.
+ */
+void ktab_destroy(ktab_t* t);
+
+#endif
@@ -41,6 +41,13 @@ linurn_t* linurn_create(ullong seed, ullong ncolors);
  */
 linurn_t* linurn_copy(linurn_t* u, ullong seed);
 
+/*
+ *  Description: Restarts the random number generator of the urn from seed.
+ */
+static inline void linurn_seed(linurn_t* u, ullong seed) {
+    mt_init(&(u->mt), seed);
+}
+
 /*
  *   Description: Sampling with or without replacement as long as there are still marbles in the
  *                urn.
@@ -13,51 +13,464 @@
 #include "linurn.h"
 #include "bsturn.h"
 #include "aliurn.h"
+#include "trtab.h"
+#include "ktab.h"
+#include "snap.h"
+#include "graph.h"
+
+#include <time.h>
+
+// Maximum number of states of the specialised sequential simulator
+#define POPSIM_SMALL_MAX 16
 
 typedef unsigned long long ullong;
 typedef long double        ldouble;
 
+/*
+ *  Description: Stop condition of a simulation which holds if any of its criteria holds. Criteria
+ *               which are NULL are ignored. Once the simulation has returned, stopped tells
+ *               whether the condition was met and step holds the number of interactions after
+ *               which the simulation stopped. nagents is set by the simulation itself.
+ *   Parameters:
+ *             - silent is a transition table of the protocol and holds if no active transition
+ *               applies to the configuration. ksilent is the same for a protocol with k-ary
+ *               interactions.
+ *             - set holds nset states and holds if all agents are in those states.
+ *             - pred is a user predicate on the counts dist of the nstates states which holds if
+ *               it returns non-zero for arg.
+ */
+typedef struct popsim_stop_t {
+    trtab_t* silent;
+    ktab_t*  ksilent;
+    ullong*  set;
+    ullong   nset;
+    int    (*pred)(ullong* dist, ullong nstates, void* arg);
+    void*    arg;
+
+    int      stopped;
+    ullong   step;
+    ullong   nagents;
+} popsim_stop_t;
+
+/*
+ *   Description: Evaluates the stop condition stop on the configuration dist.
+ *  Return value: Non-zero if the condition holds and zero otherwise.
+ */
+int popsim_stopcond(popsim_stop_t* stop, ullong* dist, ullong nstates);
+
+/*
+ *  Description: Policy which decides on the number of collisions per epoch of the multi batched
+ *               simulators, where the batch phase is run after every epoch. begin is called at the
+ *               start of every epoch and end at its end with the number of collisions ncoll, the
+ *               number of interactions nint of the epoch and the collision-free length lastl of
+ *               the last collision. Afterwards, epoch has to hold the number of collisions for the
+ *               next epoch. Custom policies can keep their state in arg.
+ */
+typedef struct popsim_epoch_t {
+    void (*begin)(struct popsim_epoch_t* p);
+    void (*end)  (struct popsim_epoch_t* p, ullong ncoll, ullong nint, ullong lastl);
+    ullong epoch;
+    void*  arg;
+
+    // State of the built-in policies
+    int             dir;
+    ldouble         pput;
+    ldouble         ccost, bcost;
+    struct timespec start;
+} popsim_epoch_t;
+
+/*
+ *  Description: Initializes p as the timing based policy, which measures the throughput of every
+ *               epoch on the monotonic clock and changes the epoch by one in the same direction as
+ *               long as the throughput increases. The results depend on the machine load, even for
+ *               fixed seeds.
+ */
+void popsim_epoch_timed(popsim_epoch_t* p, ullong nstates, ullong nagents);
+
+/*
+ *  Description: Initializes p as the deterministic policy, which estimates the cost of an epoch
+ *               from nstates and the observed collision lengths. The epoch is increased as long
+ *               as the interactions added by one more collision are cheaper than the average ones
+ *               of the epoch and decreased otherwise. Thus, runs with fixed seeds are reproducible.
+ */
+void popsim_epoch_model(popsim_epoch_t* p, ullong nstates, ullong nagents);
+
+/*
+ *  Description: Noise model of the batched simulators, where every interaction is corrupted
+ *               independently with probability eps. A corrupted interaction does not apply delta,
+ *               instead its initiator flips to a state drawn from target and its responder keeps
+ *               its state. target holds the probabilities of the nstates states and if it is NULL,
+ *               then the flipped state is uniform.
+ */
+typedef struct popsim_noise_t {
+    ldouble  eps;
+    ldouble* target;
+} popsim_noise_t;
+
 /*
  *  Description: Sequential simulation where each step is simulated one after the other.
  *   Parameters: 
  *             - u is a urn holding the initial state configuration with a total of nstates states
  *               and atleast two agents.
  *             - nsteps is the number of steps which need to be simulated.
- *             - nconf is the number of configuration snapshots to be taken excluding the initial
- *               and including the final configuration which are all stored in conf. The snapshots
- *               are taken at equidistant interaction steps of size nsteps/nconf floored.
- *             - conf needs to be allocated as a two dimensional array with (nconf+1) as the size of
- *               the first dimension and nstates as the size of the second one. It will be filled
- *               with the initial and final configuration as well as (nconf-1) steps in between.
+ *             - snap is the schedule of the configuration snapshots to be taken excluding the
+ *               initial and including the final configuration which are all stored in conf. Each
+ *               snapshot is taken after exactly the scheduled number of interaction steps.
+ *             - conf needs to be allocated as a two dimensional array with (snap_nsnap(snap)+1) as
+ *               the size of the first dimension and nstates as the size of the second one. It will
+ *               be filled with the initial configuration followed by the scheduled snapshots.
+ *             - stop is an optional stop condition which is checked after every interaction
+ *               changing the configuration. Once it holds, the remaining snapshots are filled with
+ *               the final configuration. If stop is NULL, then all nsteps steps are simulated.
  *  Assumptions:
  *             - 1 <= min(nstates,nsteps)
- *             - 1 <= nconf <= nsteps
- *             - max(nstates, nsteps, nconf) < ULLONG_MAX
+ *             - the last step of snap is nsteps
+ *             - max(nstates, nsteps) < ULLONG_MAX
  */
-void popsim_seqarr(arrurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                  void (*delta)(ullong, ullong, ullong*, ullong*));
-void popsim_seqlin(linurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                  void (*delta)(ullong, ullong, ullong*, ullong*));
-void popsim_seqbst(bsturn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                  void (*delta)(ullong, ullong, ullong*, ullong*));
-void popsim_seqali(aliurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                  void (*delta)(ullong, ullong, ullong*, ullong*));
+void popsim_seqarr(arrurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop);
+void popsim_seqlin(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop);
+void popsim_seqbst(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop);
+void popsim_seqali(aliurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop);
+
+/*
+ *   Description: Sequential simulation of nreps independent replicas on bst urns, where every
+ *                step is taken by all running replicas at once. Their tree descents and ascents
+ *                are interleaved by bsturn_mdraw and bsturn_minsert, such that the cache misses
+ *                and the unpredictable comparisons of the replicas overlap instead of stalling
+ *                each replica in turn. Every replica follows the same trajectory as
+ *                popsim_seqbst on its urn.
+ *    Parameters: u holds the urns of the replicas, conf their snapshot arrays and stop either NULL
+ *                or an array of nreps stop conditions. For the rest, see sequential simulators.
+ *   Assumptions: nreps <= BSTURN_MAXDRAW and all urns have nstates colors, for the rest see
+ *                sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: EDOM if nreps > BSTURN_MAXDRAW.
+ */
+int popsim_seqbsti(bsturn_t** u, ullong nreps, ullong nsteps, ullong nstates, snap_t* snap,
+                   ullong** conf, void (*delta)(ullong, ullong, ullong*, ullong*),
+                   popsim_stop_t* stop);
+
+/*
+ *  Description: Rare event of multilevel splitting, which occurs once the level of the
+ *               configuration reaches the last of the increasing thresholds. The level is given by
+ *               a user function on the counts dist of the nstates states for arg. The ntraj
+ *               trajectories of every stage are spread over nbatch independent splittings. Once
+ *               the splitting has returned, cond holds the fraction of trajectories of every stage
+ *               which crossed its threshold, prob the estimated probability of the event and
+ *               [lo,hi] its 95% confidence interval.
+ */
+typedef struct popsim_split_t {
+    ldouble (*level)(ullong* dist, ullong nstates, void* arg);
+    void*     arg;
+    ldouble*  thresh;
+    ullong    nlevels;
+    ullong    ntraj;
+    ullong    nbatch;
+
+    ldouble*  cond;
+    ldouble   prob, lo, hi;
+} popsim_split_t;
+
+/*
+ *   Description: Estimates the probability that the rare event of sp occurs within nsteps steps
+ *                by fixed effort multilevel splitting. The trajectories are simulated
+ *                sequentially as in popsim_seqbst. A trajectory crossing a threshold is kept with
+ *                the step of the crossing, and the next stage clones these urns with bsturn_copy
+ *                and a fresh seed in turns. A trajectory fails if it reaches nsteps steps or its
+ *                stop condition holds. Every batch estimates the probability by the product of
+ *                the fractions of its stages. The estimate is the mean of the batches and the
+ *                confidence interval is Student's t interval of their spread, since the clones of
+ *                a common ancestor make the stages of a batch dependent. If no batch crossed every
+ *                threshold, then hi is bounded by the rule of three on the first empty stage.
+ *                Additionally, this function requires a random number generator seed.
+ *    Parameters: u is the initial configuration and is left unchanged, stop is either NULL or a
+ *                condition that ends a trajectory as failed and sp holds the event, where cond
+ *                needs to hold nlevels members. For the rest, see sequential simulators.
+ *   Assumptions: 2 <= nbatch <= ntraj and 1 <= nlevels, for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the trajectories and EDOM if the
+ *                assumptions on sp are violated.
+ */
+int popsim_split(bsturn_t* u, ullong nsteps, ullong nstates,
+                 void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop,
+                 popsim_split_t* sp, ullong seed);
+
+/*
+ *   Description: Sequential simulation specialised at compile time for protocols with at most
+ *                POPSIM_SMALL_MAX states. The kernel for the smallest of 4, 8 or 16 states fitting
+ *                nstates is picked, which keeps the counts in a fixed-size array, delta in a byte
+ *                table built once and finds the drawn agents by an unrolled linear scan. The
+ *                random agents are drawn by multiplication instead of division. Additionally, this
+ *                function requires a random number generator seed.
+ *    Parameters: See sequential simulators.
+ *   Assumptions: nstates <= POPSIM_SMALL_MAX, for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: EDOM if nstates > POPSIM_SMALL_MAX.
+ */
+int popsim_seqsmall(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                    void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop,
+                    ullong seed);
+
+/*
+ *   Description: Sequential simulation of nreps independent replicas of the same protocol, where
+ *                groups of 16 replicas are advanced in lock-step. The counts of a group are kept
+ *                as a structure of arrays, such that every step draws the agents of all replicas
+ *                with vectorised bounded random numbers, finds them by a vectorised linear scan
+ *                and gathers the transitions from a table of delta. An AVX-512 or AVX2 kernel is
+ *                picked at runtime if the processor supports it and a scalar one otherwise, where
+ *                all of them run exactly the same steps. Stop conditions are checked after blocks
+ *                of at most 16 steps and a replica whose condition holds replays its last block to
+ *                find the exact step, thus conditions that might stop holding again within a block
+ *                can be missed. Additionally, this function requires a random number generator
+ *                seed.
+ *    Parameters: u holds the urns of the replicas, conf their snapshot arrays and stop either NULL
+ *                or an array of nreps stop conditions. For the rest, see sequential simulators.
+ *   Assumptions: All urns hold the same number n of agents, 2 <= n < 2^31 and nstates < 2^16,
+ *                for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the groups and EDOM if the assumptions
+ *                on the number of agents and states are violated.
+ */
+int popsim_lockstep(linurn_t** u, ullong nreps, ullong nsteps, ullong nstates, snap_t* snap,
+                    ullong** conf, void (*delta)(ullong, ullong, ullong*, ullong*),
+                    popsim_stop_t* stop, ullong seed);
+
+/*
+ *   Description: Sequential simulation which skips null interactions, i.e. those where delta is
+ *                the identity. The active transitions of tr are kept in a bst urn weighted by the
+ *                number of agent pairs they apply to, such that the number of null interactions
+ *                up to the next productive one is sampled at once from a geometric distribution
+ *                and only productive pairs are drawn. The steps are still counted exactly, thus
+ *                the snapshots are the same as for the sequential simulators. Additionally, this
+ *                function requires two random number generator seeds.
+ *    Parameters: tr must hold the active transitions of the protocol. For the rest, see
+ *                sequential simulators.
+ *   Assumptions: n*(n-1) < ULLONG_MAX where n is the number of agents, for the rest see
+ *                sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the transition urn.
+ */
+int popsim_seqskip(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   trtab_t* tr, popsim_stop_t* stop, ullong seed1, ullong seed2);
 
 /*
  *   Description: Batched simulation where multiple steps are simulated at once.
- *    Parameters: The configuration snapshots will be taken once the interaction steps are larger or
- *                equal than the equidistant steps. If the equidistant steps are smaller, then they
- *                will be filled up by the previous snapshot. Additionally, these functions require
- *                three random number generator seeds. For the rest, see sequential simulators.
+ *    Parameters: A batch which would cross the next snapshot step is truncated there, which is
+ *                exact since all interactions before the first collision are independent of each
+ *                other. Thus, the snapshots are taken at the same steps as for the sequential
+ *                simulators. Additionally, these functions require three random number generator
+ *                seeds. If the transition table tr holding the active transitions of delta is
+ *                given, then the batch phase only walks the occupied states and the active
+ *                transitions, otherwise delta is evaluated for every occupied pair of states. The
+ *                stop condition is only checked at the end of each batch, thus the stop step may
+ *                overshoot the exact one by up to a batch. The epoch policy ep of the multi
+ *                batched simulator is initialized by the caller and if it is NULL, then the timing
+ *                based policy is used. If the noise model noise is given, then the interactions
+ *                of every batch are thinned by binomial and hypergeometric samples into corrupted
+ *                and regular ones, such that noise costs O(nstates) per batch.
+ *                For the rest, see sequential simulators.
  *   Assumptions: See sequential simulators.
  *  Return value: Non-zero if everything went alright and zero otherwise.
  *        Errors: ENOMEM if there was not enough memory for the helper data structures.
  */
-int popsim_batch (linurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                  void (*delta)(ullong, ullong, ullong*, ullong*),
+int popsim_batch (linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                  popsim_stop_t* stop, popsim_noise_t* noise,
                   ullong seed1, ullong seed2, ullong seed3);
-int popsim_mbatch(bsturn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                  void (*delta)(ullong, ullong, ullong*, ullong*),
+int popsim_mbatch(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                  popsim_stop_t* stop, popsim_noise_t* noise, popsim_epoch_t* ep,
                   ullong seed1, ullong seed2, ullong seed3);
 
+/*
+ *   Description: Multi batched simulation of a single run where the batch phase is split among
+ *                nworkers threads including the calling one. Every worker owns a contiguous range
+ *                of initiator states and an exact multivariate hypergeometric share of the
+ *                responders, such that the output has the same distribution as popsim_mbatch.
+ *                The collision phase stays sequential, thus only protocols whose batch phase
+ *                dominates, i.e. those with many states, benefit from more workers.
+ *    Parameters: See batched simulators.
+ *   Assumptions: 1 <= nworkers and tr can be NULL, for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures and EAGAIN
+ *                if the worker threads could not be created.
+ */
+int popsim_pmbatch(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                   popsim_stop_t* stop, popsim_noise_t* noise, popsim_epoch_t* ep,
+                   ullong nworkers, ullong seed1, ullong seed2, ullong seed3);
+
+/*
+ *   Description: Batched simulation of two protocols on common random numbers, which runs them in
+ *                lock-step from the configurations in u[0] and u[1] such that the difference of
+ *                their outcomes has a smaller variance than that of independent runs. Both lanes
+ *                share the batch lengths, since they only depend on the number of agents, and the
+ *                random number generators of the hypergeometric samplers are reseeded identically
+ *                in every round, such that the uniforms stay aligned even if the lanes consume a
+ *                different amount of them. The collision steps draw the same uniforms from the
+ *                reseeded urns as well. Each lane on its own has the same distribution as
+ *                popsim_batch without noise. The coupling is strongest while the configurations
+ *                of the lanes stay close, e.g. for nearby initial configurations or small changes
+ *                of the protocol, since the hypergeometric sampler mirrors a sample at half of the
+ *                population and two lanes on opposite sides of it are anti-correlated.
+ *    Parameters: Every array holds one member per lane, where stop is either NULL or holds two
+ *                stop conditions and a stopped lane drops out while the other one continues. For
+ *                the rest, see batched simulators.
+ *   Assumptions: Both urns hold the same number of agents and the protocols share the states.
+ *                See sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures and EDOM if
+ *                the urns hold a different number of agents.
+ */
+int popsim_crn(linurn_t** u, ullong nsteps, ullong nstates, snap_t* snap, ullong** conf,
+               void (**delta)(ullong, ullong, ullong*, ullong*), trtab_t** tr,
+               popsim_stop_t* stop, ullong seed1, ullong seed2, ullong seed3);
+
+/*
+ *   Description: Hybrid simulation which switches between sequential steps on the bst urn and
+ *                epochs of the multi batched simulation while it runs. The seconds per interaction
+ *                of either engine are measured on the monotonic clock and the faster one is used,
+ *                where the slower one is retried every few rounds since the costs change with the
+ *                configuration. Both engines are exact and only switch at the end of an epoch,
+ *                thus the output has the same distribution as for the other simulators.
+ *    Parameters: See multi batched simulators. The stop condition is checked after every
+ *                interaction during sequential steps and after every epoch otherwise.
+ *   Assumptions: See sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures.
+ */
+int popsim_hybrid(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                  popsim_stop_t* stop, popsim_epoch_t* ep,
+                  ullong seed1, ullong seed2, ullong seed3);
+
+/*
+ *   Description: Approximate leaping simulation for very large populations. Every round is a
+ *                single batch phase of up to half of the agents, which are paired uniformly at
+ *                random from the current counts by mhgeom, but without sampling the first
+ *                collision, thus agents interact at most once per round. The length of a round is
+ *                chosen by the leap condition, i.e. the expected change and the standard deviation
+ *                of every state count over the round stay below eps times the count, or a single
+ *                agent for small counts. Rounds below a minimum length fall back to exact
+ *                sequential steps and silent configurations are skipped up to the next snapshot.
+ *    Parameters: eps is the error tolerance, where smaller values give shorter and more accurate
+ *                rounds. For the rest, see batched simulators.
+ *   Assumptions: 0 < eps, for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures.
+ */
+int popsim_leap(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                popsim_stop_t* stop, ldouble eps, ullong seed1);
+
+/*
+ *   Description: Hybrid of the mean-field ODE and the multi batched simulation. As long as every
+ *                state holds at least thresh agents, the fractions of agents per state follow the
+ *                mean-field ODE of the active transitions of tr, which is integrated in parallel
+ *                time by an adaptive Dormand-Prince 5(4) method and rounded to the urn after every
+ *                step. Once a state drops below thresh agents or an empty state would be
+ *                populated, the exact multi batched simulation takes over epoch by epoch until all
+ *                states are large again.
+ *    Parameters: thresh is the smallest count of an occupied state handled by the mean-field and
+ *                tol the relative error tolerance of a single step. For the rest, see batched
+ *                simulators. The stop condition is checked after every step and every epoch.
+ *   Assumptions: tr holds the active transitions of delta and 0 < tol, for the rest see
+ *                sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures.
+ */
+int popsim_ode(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+               void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+               popsim_stop_t* stop, popsim_epoch_t* ep, ullong thresh, ldouble tol,
+               ullong seed1, ullong seed2, ullong seed3);
+
+/*
+ *   Description: Sequential simulation on the interaction graph g, where every step draws a
+ *                uniform edge in a uniform orientation and applies delta to the states of both
+ *                endpoints. The agents of dist are placed uniformly at random on the vertices and
+ *                their states are kept in an array of the narrowest unsigned type holding nstates
+ *                states, as for the array urn. The state counts are updated with every interaction,
+ *                thus a snapshot costs O(nstates) regardless of the number of agents.
+ *    Parameters: dist is the initial configuration of graph_nvert(g) agents and seed seeds the
+ *                random number generator. For the rest, see sequential simulators.
+ *   Assumptions: g was built and has at least one edge, for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the agent states.
+ */
+int popsim_graph(graph_t* g, ullong* dist, ullong nsteps, ullong nstates, snap_t* snap,
+                 ullong* conf, void (*delta)(ullong, ullong, ullong*, ullong*),
+                 popsim_stop_t* stop, ullong seed);
+
+/*
+ *   Description: Synchronous simulation in rounds, where every round matches all agents uniformly
+ *                at random, apart from one idle agent for an odd population, and all pairs
+ *                interact at once. The pair counts of a round are sampled directly from the state
+ *                counts by the batch phase of the batched simulators with floor(n/2) pairs, thus a
+ *                round costs O(nstates^2) instead of O(n).
+ *    Parameters: nrounds is the number of rounds and the snapshot schedule snap as well as the
+ *                step of the stop condition, which is checked after every round, count rounds
+ *                instead of interactions. For the rest, see batched simulators.
+ *   Assumptions: See sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures.
+ */
+int popsim_rounds(linurn_t* u, ullong nrounds, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                  popsim_stop_t* stop, ullong seed1);
+
+/*
+ *   Description: Approximate partitioned simulation of a single run, which scales linearly with
+ *                the number of threads. The population is split into nparts partitions of about
+ *                the same size, each simulated by the multi batched simulator on its own thread
+ *                where agents only interact within their partition. Every period units of
+ *                parallel time, i.e. period*n interactions, the agents are dealt to the
+ *                partitions anew uniformly at random by exact hypergeometric samples. Thus,
+ *                period is the accuracy knob: the smaller it is, the closer the run follows the
+ *                well-mixed population and the more time is spent on the reshuffles, which cost
+ *                O(nparts*nstates) each. Every partition advances the same parallel time per
+ *                period and uses the deterministic epoch policy.
+ *    Parameters: Periods end early at the snapshot steps, such that the snapshots are taken at the
+ *                same steps as for the sequential simulators, and the stop condition is checked
+ *                after every period. For the rest, see batched simulators.
+ *   Assumptions: 1 <= nparts <= n/2 and period > 0, for the rest see sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the partitions, EAGAIN if the threads
+ *                could not be created and EDOM if nparts or period are invalid.
+ */
+int popsim_partition(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                     void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                     popsim_stop_t* stop, ullong nparts, ldouble period,
+                     ullong seed1, ullong seed2, ullong seed3);
+
+/*
+ *   Description: Sequential simulation of a protocol with k-ary interactions, where every step
+ *                draws k distinct agents uniformly at random as an ordered tuple and applies the
+ *                transition of kt to them.
+ *    Parameters: nsteps counts k-ary interactions and kt holds the transitions. For the rest, see
+ *                sequential simulators.
+ *   Assumptions: The urn holds at least k agents. See sequential simulators.
+ */
+void popsim_kseq(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                 ktab_t* kt, popsim_stop_t* stop);
+
+/*
+ *   Description: Batched simulation of a protocol with k-ary interactions, which generalizes the
+ *                batched simulator from pairs to k-tuples. The collision-free run of l agents
+ *                holds floor(l/k) interactions, whose tuple counts are sampled by splitting the k
+ *                drawn groups of agents position by position. Only prefixes of keys with an active
+ *                transition are split further, thus a batch costs O(nstates) per occupied active
+ *                prefix and the time per interaction is sub-constant as for pairs.
+ *    Parameters: nsteps counts k-ary interactions and kt holds the transitions. For the rest, see
+ *                batched simulators.
+ *   Assumptions: The urn holds at least k agents. See sequential simulators.
+ *  Return value: Non-zero if everything went alright and zero otherwise.
+ *        Errors: ENOMEM if there was not enough memory for the helper data structures.
+ */
+int popsim_kbatch(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  ktab_t* kt, popsim_stop_t* stop, ullong seed1, ullong seed2, ullong seed3);
+
 #endif
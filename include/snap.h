@@ -0,0 +1,115 @@
+/*
+ *      Filename: snap.h
+ *   Description: Snapshot schedules which define after how many interaction steps the
+ *                configuration snapshots of a simulation are taken. A schedule holds a strictly
+ *                increasing list of steps in [1,nsteps] whose last step is always nsteps, such that
+ *                the final configuration is always included. The initial configuration is not part
+ *                of the schedule, thus a simulation with schedule s needs snap_nsnap(s)+1 slots.
+ *                Continuous time schedules hold a strictly increasing list of times in (0,tmax]
+ *                instead, whose last time is always tmax.
+ *   Assumptions: A schedule needs to be created before and destroyed after use.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#ifndef SNAP_H
+#define SNAP_H
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+// Should be treated as opaque.
+typedef struct snap_t {
+    ullong   nsnap;
+    ullong*  steps;
+    ldouble* times;
+} snap_t;
+
+/*
+ *   Description: Creates a schedule of nsnap snapshots at the equidistant steps j*(nsteps/nsnap)
+ *                floored for j in [1,nsnap) and at nsteps.
+ *  Return value: A pointer to the schedule or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the schedule and EDOM if nsnap == 0 or
+ *                nsnap > nsteps.
+ */
+snap_t* snap_equi(ullong nsteps, ullong nsnap);
+
+/*
+ *   Description: Creates a schedule of at most nsnap snapshots at the logarithmically spaced steps
+ *                nsteps^(j/nsnap) floored for j in [1,nsnap]. Steps which coincide after flooring
+ *                are only taken once, thus the schedule may hold less than nsnap snapshots.
+ *  Return value: A pointer to the schedule or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the schedule and EDOM if nsnap == 0 or
+ *                nsteps == 0.
+ */
+snap_t* snap_log(ullong nsteps, ullong nsnap);
+
+/*
+ *   Description: Creates a schedule in parallel time, where one unit of parallel time corresponds
+ *                to nagents interactions. The snapshots are taken every dt units of parallel time,
+ *                i.e. at the steps j*dt*nagents floored, and at nsteps. Steps which coincide after
+ *                flooring are only taken once.
+ *  Return value: A pointer to the schedule or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the schedule and EDOM if dt is not
+ *                positive, nagents == 0 or nsteps == 0.
+ */
+snap_t* snap_ptime(ullong nsteps, ullong nagents, ldouble dt);
+
+/*
+ *   Description: Creates a schedule from the explicit list of nsteplist steps. The list does not
+ *                need to be sorted, duplicates as well as steps not in [1,nsteps] are dropped and
+ *                nsteps is appended if it is not part of the list.
+ *  Return value: A pointer to the schedule or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the schedule and EDOM if nsteps == 0.
+ */
+snap_t* snap_list(ullong nsteps, ullong* steplist, ullong nsteplist);
+
+/*
+ *   Description: Creates a continuous time schedule of nsnap snapshots at the equidistant times
+ *                j*tmax/nsnap for j in [1,nsnap].
+ *  Return value: A pointer to the schedule or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the schedule and EDOM if nsnap == 0 or
+ *                tmax is not positive.
+ */
+snap_t* snap_cequi(ldouble tmax, ullong nsnap);
+
+/*
+ *   Description: Creates a continuous time schedule from the explicit list of ntimelist times,
+ *                analogously to snap_list.
+ *  Return value: A pointer to the schedule or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the schedule and EDOM if tmax is not
+ *                positive.
+ */
+snap_t* snap_clist(ldouble tmax, ldouble* timelist, ullong ntimelist);
+
+/*
+ *   Description: Getter function for the number of snapshots excluding the initial configuration.
+ */
+static inline ullong snap_nsnap(snap_t* s) {
+    return s->nsnap;
+}
+
+/*
+ *   Description: Getter function for the step of the j-th snapshot, where the initial
+ *                configuration is the 0-th one.
+ *   Assumptions: 1 <= j <= snap_nsnap(s)
+ */
+static inline ullong snap_step(snap_t* s, ullong j) {
+    return s->steps[j-1];
+}
+
+/*
+ *   Description: Getter function for the time of the j-th snapshot of a continuous time schedule,
+ *                where the initial configuration is the 0-th one.
+ *   Assumptions: 1 <= j <= snap_nsnap(s)
+ */
+static inline ldouble snap_time(snap_t* s, ullong j) {
+    return s->times[j-1];
+}
+
+/*
+ *   Description: Frees the memory kept by the schedule.
+ */
+void snap_destroy(snap_t* s);
+
+#endif
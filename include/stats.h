@@ -0,0 +1,63 @@
+/*
+ *      Filename: stats.h
+ *   Description: Streaming summary statistics of a sequence of observations, where the mean and
+ *                the sum of squared deviations are updated by Welford's method, such that the
+ *                variance stays accurate for long sequences with a large mean, as well as the 95%
+ *                confidence interval of the mean by Student's t distribution.
+ *   Assumptions: The statistics need to be initialized before use.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+typedef struct stats_t {
+    ullong  n;
+    ldouble mean, m2;
+} stats_t;
+
+/*
+ *  Description: Initializes the statistics of an empty sequence.
+ */
+static inline void stats_init(stats_t* s) {
+    s->n    = 0;
+    s->mean = 0.L;
+    s->m2   = 0.L;
+}
+
+/*
+ *  Description: Appends the observation x to the sequence.
+ */
+static inline void stats_add(stats_t* s, ldouble x) {
+    ldouble d = x - s->mean;
+    s->n++;
+    s->mean += d / s->n;
+    s->m2   += d * (x - s->mean);
+}
+
+/*
+ *   Description: Sample variance of the sequence.
+ *  Return value: The variance or zero if the sequence holds less than two observations.
+ */
+static inline ldouble stats_var(stats_t* s) {
+    return (s->n > 1) ? s->m2 / (s->n-1) : 0.L;
+}
+
+/*
+ *   Description: Quantile of the two-sided 95% interval of Student's t distribution, where the
+ *                normal quantile is used beyond 30 degrees of freedom.
+ *   Assumptions: df >= 1.
+ */
+ldouble stats_tquant(ullong df);
+
+/*
+ *   Description: Half width of the 95% confidence interval of the mean of the sequence.
+ *  Return value: The half width or infinity if the sequence holds less than two observations.
+ */
+ldouble stats_half(stats_t* s);
+
+#endif
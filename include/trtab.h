@@ -0,0 +1,111 @@
+/*
+ *      Filename: trtab.h
+ *   Description: Sparse transition table which only keeps the transitions of a population protocol
+ *                that are not the identity. After being built, the transitions are stored in
+ *                compressed sparse row format sorted by the initiator and then by the responder
+ *                state, such that all active transitions of an initiator can be walked in order.
+ *                Additionally, the transitions of each responder are indexed as well.
+ *   Assumptions: The table needs to be created before and destroyed after use, all transitions
+ *                need to be inserted before it is built and states are represented as integers in
+ *                [0,nstates).
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#ifndef TRTAB_H
+#define TRTAB_H
+
+typedef unsigned long long ullong;
+
+typedef struct trans_t {
+    ullong k[2];
+    ullong v[2];
+} trans_t;
+
+// Should be treated as opaque.
+typedef struct trtab_t {
+    ullong nstates;
+    ullong ntrans;
+    ullong max_ntrans;
+
+    trans_t* trans;
+    ullong*  rstart;
+    ullong*  cstart;
+    ullong*  cidx;
+} trtab_t;
+
+/*
+ *   Description: Initializes and allocates a new table for at most max_ntrans transitions.
+ *  Return value: A pointer to the table or NULL on error.
+ *        Errors: ENOMEM if there was not enough memory for the table and EDOM if
+ *                nstates == ULLONG_MAX.
+ */
+trtab_t* trtab_create(ullong nstates, ullong max_ntrans);
+
+/*
+ *   Description: Inserts the transition (kfst,kscd)->(vfst,vscd) into the table unless it is the
+ *                identity.
+ *  Return value: Zero if the table was already full and non-zero otherwise.
+ *   Assumptions: No duplicate keys shall be inserted and the table is not built yet.
+ */
+int trtab_insert(trtab_t* t, ullong kfst, ullong kscd, ullong vfst, ullong vscd);
+
+/*
+ *   Description: Sorts the inserted transitions into compressed sparse row format.
+ */
+void trtab_build(trtab_t* t);
+
+/*
+ *   Description: Getter function for the i-th active transition in the sorted order.
+ *   Assumptions: The table was built and i < ntrans.
+ */
+static inline trans_t* trtab_trans(trtab_t* t, ullong i) {
+    return t->trans + i;
+}
+
+/*
+ *   Description: Getter functions for the active transitions of the initiator p, which are
+ *                given by the transitions in [trtab_rbegin(t,p),trtab_rend(t,p)).
+ *   Assumptions: The table was built and p < nstates.
+ */
+static inline trans_t* trtab_rbegin(trtab_t* t, ullong p) {
+    return t->trans + t->rstart[p];
+}
+
+static inline trans_t* trtab_rend(trtab_t* t, ullong p) {
+    return t->trans + t->rstart[p+1];
+}
+
+/*
+ *   Description: Getter functions for the indices of the active transitions of the responder q,
+ *                which are given by the indices in [trtab_cbegin(t,q),trtab_cend(t,q)).
+ *   Assumptions: The table was built and q < nstates.
+ */
+static inline ullong* trtab_cbegin(trtab_t* t, ullong q) {
+    return t->cidx + t->cstart[q];
+}
+
+static inline ullong* trtab_cend(trtab_t* t, ullong q) {
+    return t->cidx + t->cstart[q+1];
+}
+
+/*
+ *   Description: Getter function for the number of active transitions.
+ */
+static inline ullong trtab_ntrans(trtab_t* t) {
+    return t->ntrans;
+}
+
+/*
+ *   Description: Checks whether the configuration dist is silent, i.e. no active transition of the
+ *                table applies to any pair of its agents.
+ *  Return value: Non-zero if dist is silent and zero otherwise.
+ */
+int trtab_silent(trtab_t* t, ullong* dist);
+
+/*
+ *   Description: Frees the memory kept by the table.
+ */
+void trtab_destroy(trtab_t* t);
+
+#endif
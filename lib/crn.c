@@ -0,0 +1,320 @@
+/*
+ *      Filename: crn.c
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "crn.h"
+#include "mt.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+
+crn_t* crn_create(ullong nspecies, ullong max_nreac, ldouble vol) {
+    if(nspecies == ULLONG_MAX || !(vol > 0.L)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    crn_t* c = (crn_t*) calloc(1, sizeof(crn_t));
+    if(c == NULL) return NULL;
+
+    c->nspecies  = nspecies;
+    c->nreac     = 0;
+    c->max_nreac = max_nreac;
+    c->vol       = vol;
+
+    if((c->reac   = (reac_t*) malloc((max_nreac > 0 ? max_nreac : 1) * sizeof(reac_t))) == NULL ||
+       (c->sstart = (ullong*) calloc(nspecies+1, sizeof(ullong))) == NULL ||
+       (c->dstart = (ullong*) calloc(max_nreac+1, sizeof(ullong))) == NULL) {
+        crn_destroy(c);
+        return NULL;
+    }
+
+    return c;
+}
+
+int crn_insert(crn_t* c, ullong r1, ullong r2, ullong p1, ullong p2, ldouble rate) {
+    if(c->nreac >= c->max_nreac)
+        return 0;
+
+    // Keep absent species last, such that a single reactant is always r[0]
+    reac_t* re = c->reac + c->nreac++;
+    re->r[0] = (r1 == CRN_NONE) ? r2 : r1;
+    re->r[1] = (r1 == CRN_NONE) ? r1 : r2;
+    re->p[0] = p1;
+    re->p[1] = p2;
+    re->rate = rate;
+    return 1;
+}
+
+/*
+ *  Returns the net change of species s when reaction re fires.
+ */
+static inline long long crn_net(reac_t* re, ullong s) {
+    return (re->p[0] == s) + (re->p[1] == s) - (re->r[0] == s) - (re->r[1] == s);
+}
+
+int crn_build(crn_t* c) {
+    ullong* mark = (ullong*) malloc((c->nreac > 0 ? c->nreac : 1) * sizeof(ullong));
+    if(mark == NULL) return 0;
+
+    // Species to the reactions having them as reactant, in compressed sparse row format
+    for(ullong s = 0; s <= c->nspecies; ++s)
+        c->sstart[s] = 0;
+    for(ullong i = 0; i < c->nreac; ++i)
+        for(int k = 0; k < 2; ++k)
+            if(c->reac[i].r[k] != CRN_NONE && (k == 0 || c->reac[i].r[1] != c->reac[i].r[0]))
+                c->sstart[c->reac[i].r[k]+1]++;
+    for(ullong s = 0; s < c->nspecies; ++s)
+        c->sstart[s+1] += c->sstart[s];
+
+    free(c->sidx);
+    if((c->sidx = (ullong*) malloc((c->sstart[c->nspecies] > 0 ? c->sstart[c->nspecies] : 1) *
+                                   sizeof(ullong))) == NULL) {
+        free(mark);
+        return 0;
+    }
+    for(ullong i = 0; i < c->nreac; ++i)
+        for(int k = 0; k < 2; ++k)
+            if(c->reac[i].r[k] != CRN_NONE && (k == 0 || c->reac[i].r[1] != c->reac[i].r[0]))
+                c->sidx[c->sstart[c->reac[i].r[k]]++] = i;
+    for(ullong s = c->nspecies; s > 0; --s)
+        c->sstart[s] = c->sstart[s-1];
+    c->sstart[0] = 0;
+
+    // Two passes over the dependency graph, the first counts and the second fills. The fired
+    // reaction itself is always a dependent such that its firing time gets redrawn.
+    ullong* spec[2][2];
+    for(int pass = 0; pass < 2; ++pass) {
+        ullong n = 0;
+        for(ullong i = 0; i < c->nreac; ++i)
+            mark[i] = ULLONG_MAX;
+        for(ullong i = 0; i < c->nreac; ++i) {
+            reac_t* re = c->reac + i;
+            spec[0][0] = re->r; spec[0][1] = re->r + 1;
+            spec[1][0] = re->p; spec[1][1] = re->p + 1;
+
+            if(pass == 0) c->dstart[i] = n;
+            else          c->didx[n] = i;
+            mark[i] = i;
+            ++n;
+
+            for(int a = 0; a < 2; ++a) {
+                for(int b = 0; b < 2; ++b) {
+                    ullong s = *spec[a][b];
+                    if(s == CRN_NONE || crn_net(re, s) == 0)
+                        continue;
+                    for(ullong k = c->sstart[s]; k < c->sstart[s+1]; ++k) {
+                        if(mark[c->sidx[k]] == i)
+                            continue;
+                        mark[c->sidx[k]] = i;
+                        if(pass == 1) c->didx[n] = c->sidx[k];
+                        ++n;
+                    }
+                }
+            }
+        }
+
+        if(pass == 0) {
+            c->dstart[c->nreac] = n;
+            free(c->didx);
+            if((c->didx = (ullong*) malloc((n > 0 ? n : 1) * sizeof(ullong))) == NULL) {
+                free(mark);
+                return 0;
+            }
+        }
+    }
+
+    free(mark);
+    return 1;
+}
+
+/*
+ *  Applies the net change of reaction re to the urn.
+ */
+static inline void crn_fire(reac_t* re, linurn_t* u) {
+    for(int k = 0; k < 2; ++k)
+        if(re->r[k] != CRN_NONE)
+            linurn_cremove(u, re->r[k], 1);
+    for(int k = 0; k < 2; ++k)
+        if(re->p[k] != CRN_NONE)
+            linurn_cinsert(u, re->p[k], 1);
+}
+
+/*
+ *  Samples an exponentially distributed waiting time of the given rate.
+ */
+static inline ldouble crn_exp(mt_t* mt, ldouble rate) {
+    return -logl(mt_real3(mt)) / rate;
+}
+
+ullong crn_direct(crn_t* c, linurn_t* u, snap_t* snap, ullong* conf, ullong seed) {
+    ullong nconf = snap_nsnap(snap);
+    ullong nspecies = c->nspecies;
+    ullong* dist = linurn_dist(u);
+    memcpy(conf, dist, nspecies * sizeof(ullong));
+
+    ldouble* prop = (ldouble*) malloc((c->nreac > 0 ? c->nreac : 1) * sizeof(ldouble));
+    if(prop == NULL) return ULLONG_MAX;
+
+    mt_t mt;
+    mt_init(&mt, seed);
+
+    ldouble a0 = 0.L;
+    for(ullong i = 0; i < c->nreac; ++i)
+        a0 += (prop[i] = crn_prop(c, i, dist));
+
+    ldouble t = 0.L;
+    ullong j = 1, nfired = 0;
+    while(j <= nconf) {
+        if(!(a0 > 0.L))
+            break;
+
+        t += crn_exp(&mt, a0);
+        while(j <= nconf && snap_time(snap, j) < t)
+            memcpy(conf + (j++)*nspecies, dist, nspecies * sizeof(ullong));
+        if(j > nconf)
+            break;
+
+        // Linear search, where rounding may only leave the last reaction of positive propensity
+        ldouble x = mt_real2(&mt) * a0;
+        ullong mu = ULLONG_MAX;
+        for(ullong i = 0; i < c->nreac; ++i) {
+            if(prop[i] > 0.L) {
+                mu = i;
+                if(x < prop[i]) break;
+                x -= prop[i];
+            }
+        }
+
+        crn_fire(c->reac + mu, u);
+        for(ullong k = c->dstart[mu]; k < c->dstart[mu+1]; ++k) {
+            ullong i = c->didx[k];
+            ldouble p = crn_prop(c, i, dist);
+            a0 += p - prop[i];
+            prop[i] = p;
+        }
+
+        // Resum once in a while such that the incremental updates do not accumulate errors
+        if(++nfired % (c->nreac + 1024) == 0) {
+            a0 = 0.L;
+            for(ullong i = 0; i < c->nreac; ++i)
+                a0 += prop[i];
+        }
+    }
+
+    while(j <= nconf)
+        memcpy(conf + (j++)*nspecies, dist, nspecies * sizeof(ullong));
+
+    free(prop);
+    return nfired;
+}
+
+/*
+ *  Restores the heap property of the indexed binary heap for the reaction at heap position p.
+ */
+static inline void crn_heapfix(ullong* heap, ullong* pos, ldouble* T, ullong n, ullong p) {
+    ullong i = heap[p];
+    while(p > 0 && T[heap[(p-1)/2]] > T[i]) {
+        heap[p] = heap[(p-1)/2];
+        pos[heap[p]] = p;
+        p = (p-1)/2;
+    }
+    for(;;) {
+        ullong l = 2*p + 1;
+        if(l >= n) break;
+        if(l+1 < n && T[heap[l+1]] < T[heap[l]]) ++l;
+        if(!(T[heap[l]] < T[i])) break;
+        heap[p] = heap[l];
+        pos[heap[p]] = p;
+        p = l;
+    }
+    heap[p] = i;
+    pos[i] = p;
+}
+
+ullong crn_nextreaction(crn_t* c, linurn_t* u, snap_t* snap, ullong* conf, ullong seed) {
+    ullong nconf = snap_nsnap(snap);
+    ullong nspecies = c->nspecies;
+    ullong nreac = c->nreac;
+    ullong* dist = linurn_dist(u);
+    memcpy(conf, dist, nspecies * sizeof(ullong));
+
+    ullong n = (nreac > 0 ? nreac : 1);
+    ldouble* prop = (ldouble*) malloc(n * sizeof(ldouble));
+    ldouble* T    = (ldouble*) malloc(n * sizeof(ldouble));
+    ullong*  heap = (ullong*)  malloc(n * sizeof(ullong));
+    ullong*  pos  = (ullong*)  malloc(n * sizeof(ullong));
+    if(prop == NULL || T == NULL || heap == NULL || pos == NULL) {
+        free(prop);
+        free(T);
+        free(heap);
+        free(pos);
+        return ULLONG_MAX;
+    }
+
+    mt_t mt;
+    mt_init(&mt, seed);
+
+    for(ullong i = 0; i < nreac; ++i) {
+        prop[i] = crn_prop(c, i, dist);
+        T[i] = (prop[i] > 0.L) ? crn_exp(&mt, prop[i]) : INFINITY;
+        heap[i] = i;
+        pos[i] = i;
+    }
+    for(ullong p = nreac/2; p > 0; --p)
+        crn_heapfix(heap, pos, T, nreac, p-1);
+
+    ldouble t = 0.L;
+    ullong j = 1, nfired = 0;
+    while(j <= nconf && nreac > 0) {
+        ullong mu = heap[0];
+        if(isinf(T[mu]))
+            break;
+
+        t = T[mu];
+        while(j <= nconf && snap_time(snap, j) < t)
+            memcpy(conf + (j++)*nspecies, dist, nspecies * sizeof(ullong));
+        if(j > nconf)
+            break;
+
+        crn_fire(c->reac + mu, u);
+        ++nfired;
+
+        // Rescale the remaining waiting times of the dependents, except for the fired reaction
+        // and reactions that were disabled, which need a fresh exponential by memorylessness
+        for(ullong k = c->dstart[mu]; k < c->dstart[mu+1]; ++k) {
+            ullong i = c->didx[k];
+            ldouble p = crn_prop(c, i, dist);
+            if(!(p > 0.L))
+                T[i] = INFINITY;
+            else if(i == mu || !(prop[i] > 0.L))
+                T[i] = t + crn_exp(&mt, p);
+            else
+                T[i] = t + (prop[i] / p) * (T[i] - t);
+            prop[i] = p;
+            crn_heapfix(heap, pos, T, nreac, pos[i]);
+        }
+    }
+
+    while(j <= nconf)
+        memcpy(conf + (j++)*nspecies, dist, nspecies * sizeof(ullong));
+
+    free(prop);
+    free(T);
+    free(heap);
+    free(pos);
+    return nfired;
+}
+
+void crn_destroy(crn_t* c) {
+    free(c->reac);
+    free(c->sstart);
+    free(c->sidx);
+    free(c->dstart);
+    free(c->didx);
+    free(c);
+}
@@ -0,0 +1,228 @@
+/*
+ *      Filename: graph.c
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "graph.h"
+#include "mt.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+graph_t* graph_create(ullong nvert, ullong max_nedges) {
+    if(nvert >= UINT_MAX) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    graph_t* g = (graph_t*) calloc(1, sizeof(graph_t));
+    if(g == NULL) return NULL;
+
+    g->nvert      = nvert;
+    g->nedges     = 0;
+    g->max_nedges = max_nedges;
+
+    if((g->edge   = (uint*)   malloc((max_nedges > 0 ? 2*max_nedges : 1) * sizeof(uint)))
+            == NULL || (g->rstart = (ullong*) calloc(nvert+1, sizeof(ullong))) == NULL) {
+        graph_destroy(g);
+        return NULL;
+    }
+
+    return g;
+}
+
+int graph_insert(graph_t* g, ullong v, ullong w) {
+    if(v == w)
+        return 1;
+    if(g->nedges >= g->max_nedges)
+        return 0;
+
+    g->edge[2*g->nedges]   = v;
+    g->edge[2*g->nedges+1] = w;
+    g->nedges++;
+    return 1;
+}
+
+int graph_build(graph_t* g) {
+    free(g->adj);
+    if((g->adj = (uint*) malloc((g->nedges > 0 ? 2*g->nedges : 1) * sizeof(uint))) == NULL)
+        return 0;
+
+    for(ullong v = 0; v <= g->nvert; ++v)
+        g->rstart[v] = 0;
+    for(ullong a = 0; a < 2*g->nedges; ++a)
+        g->rstart[g->edge[a]+1]++;
+    for(ullong v = 0; v < g->nvert; ++v)
+        g->rstart[v+1] += g->rstart[v];
+
+    // Every edge is an arc in either direction, where a^1 is the reverse of the arc a
+    for(ullong a = 0; a < 2*g->nedges; ++a)
+        g->adj[g->rstart[g->edge[a]]++] = g->edge[a^1];
+    for(ullong v = g->nvert; v > 0; --v)
+        g->rstart[v] = g->rstart[v-1];
+    g->rstart[0] = 0;
+
+    return 1;
+}
+
+int graph_reorder(graph_t* g) {
+    ullong n = g->nvert;
+    uint* perm  = (uint*) malloc((n > 0 ? n : 1) * sizeof(uint));
+    uint* queue = (uint*) malloc((n > 0 ? n : 1) * sizeof(uint));
+    ullong norder = (2*g->nedges > n) ? 2*g->nedges : (n > 0 ? n : 1);
+    uint* order = (uint*) malloc(norder * sizeof(uint));
+    ullong* cnt = (ullong*) calloc(n+1, sizeof(ullong));
+    if(perm == NULL || queue == NULL || order == NULL || cnt == NULL) {
+        free(perm); free(queue); free(order); free(cnt);
+        return 0;
+    }
+
+    // Breadth first search from a vertex of minimum degree of every component, where the roots
+    // are picked by a single scan over the vertices sorted by degree using counting sort
+    ullong maxdeg = 0;
+    for(ullong v = 0; v < n; ++v)
+        maxdeg = (g->rstart[v+1]-g->rstart[v] > maxdeg) ? g->rstart[v+1]-g->rstart[v] : maxdeg;
+    ullong* dstart = (ullong*) calloc(maxdeg+2, sizeof(ullong));
+    if(dstart == NULL) {
+        free(perm); free(queue); free(order); free(cnt);
+        return 0;
+    }
+    for(ullong v = 0; v < n; ++v)
+        dstart[g->rstart[v+1]-g->rstart[v]+1]++;
+    for(ullong d = 0; d <= maxdeg; ++d)
+        dstart[d+1] += dstart[d];
+    for(ullong v = 0; v < n; ++v)
+        order[dstart[g->rstart[v+1]-g->rstart[v]]++] = v;
+    free(dstart);
+
+    for(ullong v = 0; v < n; ++v)
+        perm[v] = UINT_MAX;
+    ullong head = 0, tail = 0, next = 0;
+    for(ullong r = 0; r < n; ++r) {
+        if(perm[order[r]] != UINT_MAX)
+            continue;
+        perm[order[r]] = next++;
+        queue[tail++]  = order[r];
+        while(head < tail) {
+            uint v = queue[head++];
+            for(uint* w = graph_nbegin(g, v); w < graph_nend(g, v); ++w) {
+                if(perm[*w] == UINT_MAX) {
+                    perm[*w] = next++;
+                    queue[tail++] = *w;
+                }
+            }
+        }
+    }
+
+    // Relabel the edges with the smaller endpoint first and sort them by it
+    uint v, w;
+    for(ullong e = 0; e < g->nedges; ++e) {
+        v = perm[g->edge[2*e]];
+        w = perm[g->edge[2*e+1]];
+        g->edge[2*e]   = (v < w) ? v : w;
+        g->edge[2*e+1] = (v < w) ? w : v;
+        cnt[g->edge[2*e]+1]++;
+    }
+    for(ullong u = 0; u < n; ++u)
+        cnt[u+1] += cnt[u];
+    for(ullong e = 0; e < g->nedges; ++e) {
+        ullong k = cnt[g->edge[2*e]]++;
+        order[2*k]   = g->edge[2*e];
+        order[2*k+1] = g->edge[2*e+1];
+    }
+    memcpy(g->edge, order, 2*g->nedges * sizeof(uint));
+
+    free(perm); free(queue); free(order); free(cnt);
+    return graph_build(g);
+}
+
+graph_t* graph_ring(ullong nvert) {
+    if(nvert < 2) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    // A ring of two vertices is a single edge
+    graph_t* g = graph_create(nvert, (nvert == 2) ? 1 : nvert);
+    if(g == NULL) return NULL;
+
+    for(ullong v = 0; v < g->max_nedges; ++v)
+        graph_insert(g, v, (v+1) % nvert);
+    if(graph_build(g) == 0) {
+        graph_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+graph_t* graph_grid(ullong rows, ullong cols) {
+    if(rows == 0 || cols == 0 || rows*cols < 2 || rows >= UINT_MAX / cols) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    graph_t* g = graph_create(rows*cols, 2*rows*cols);
+    if(g == NULL) return NULL;
+
+    // Wrapping edges are only added if they do not duplicate an edge, i.e. for more than two
+    // rows or columns
+    for(ullong r = 0; r < rows; ++r) {
+        for(ullong c = 0; c < cols; ++c) {
+            if(c+1 < cols || cols > 2)
+                graph_insert(g, r*cols + c, r*cols + (c+1) % cols);
+            if(r+1 < rows || rows > 2)
+                graph_insert(g, r*cols + c, ((r+1) % rows)*cols + c);
+        }
+    }
+    if(graph_build(g) == 0) {
+        graph_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+graph_t* graph_rrg(ullong nvert, ullong d, ullong seed) {
+    if(nvert < 2 || d == 0 || (nvert*d) % 2 != 0 || nvert >= UINT_MAX) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    graph_t* g = graph_create(nvert, nvert*d/2);
+    if(g == NULL) return NULL;
+
+    // Configuration model: d stubs per vertex are shuffled and paired up
+    uint* stubs = (uint*) malloc(nvert*d * sizeof(uint));
+    if(stubs == NULL) {
+        graph_destroy(g);
+        return NULL;
+    }
+    for(ullong s = 0; s < nvert*d; ++s)
+        stubs[s] = s / d;
+
+    mt_t mt;
+    mt_init(&mt, seed);
+    uint tmp;
+    for(ullong s = nvert*d-1; s > 0; --s) {
+        ullong t = mt_urand(&mt, s+1);
+        tmp = stubs[s]; stubs[s] = stubs[t]; stubs[t] = tmp;
+    }
+    for(ullong s = 0; s < nvert*d; s += 2)
+        graph_insert(g, stubs[s], stubs[s+1]);
+    free(stubs);
+
+    if(graph_build(g) == 0) {
+        graph_destroy(g);
+        return NULL;
+    }
+    return g;
+}
+
+void graph_destroy(graph_t* g) {
+    free(g->edge);
+    free(g->rstart);
+    free(g->adj);
+    free(g);
+}
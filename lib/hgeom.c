@@ -168,3 +168,253 @@ void mhgeom(mt_t* mt, ullong* destdist, ullong* srcdist,
             destdist[c] = 0LLU;
     }
 }
+
+/*
+ *  Inversion for binomials with a small mean, where every step multiplies the probability of x by
+ *  the ratio of consecutive probabilities.
+ */
+static ullong binom_inversion(mt_t* mt, ullong n, ldouble p) {
+    ldouble q = 1.L - p;
+    ldouble s = p / q;
+    ldouble a = (n+1) * s;
+    ldouble r = powl(q, n);
+    ldouble u = mt_real1(mt);
+    ullong  x = 0;
+
+    while(u > r && x < n) {
+        u -= r;
+        x++;
+        r *= a/x - s;
+    }
+    return x;
+}
+
+/*
+ *  Correction term of Stirling's approximation of log(k!), i.e. the difference between log(k!) and
+ *  (k+0.5)*log(k+1) - (k+1) + log(sqrt(2*pi)).
+ */
+static inline ldouble binom_fc(ullong k) {
+    return lfac(k) - ((k+0.5L)*logl(k+1.L) - (k+1.L) + LFAC_LN_SQRT_2PI);
+}
+
+/*
+ *  Transformed rejection with decomposition by W. Hörmann. The Generation of Binomial Random
+ *  Variates. 1993. for binomials with n*p >= 10 and p <= 0.5.
+ */
+static ullong binom_btrd(mt_t* mt, ullong n, ldouble p) {
+    ldouble q     = 1.L - p;
+    ldouble spq   = sqrtl(n*p*q);
+    ldouble b     = 1.15L + 2.53L*spq;
+    ldouble a     = -0.0873L + 0.0248L*b + 0.01L*p;
+    ldouble c     = n*p + 0.5L;
+    ldouble alpha = (2.83L + 5.1L/b) * spq;
+    ldouble vr    = 0.92L - 4.2L/b;
+    ldouble urvr  = 0.86L * vr;
+    ldouble m     = floorl((n+1)*p);
+    ldouble r     = p / q;
+    ldouble nr    = (n+1) * r;
+    ldouble npq   = n*p*q;
+    ldouble u, v, us, k, km, f, rho, t, h, nm, nk;
+
+    for(;;) {
+        v = mt_real1(mt);
+        if(v <= urvr) {
+            u = v/vr - 0.43L;
+            return (ullong) floorl((2.L*a/(0.5L - fabsl(u)) + b)*u + c);
+        }
+
+        if(v >= vr) {
+            u = mt_real1(mt) - 0.5L;
+        } else {
+            u = v/vr - 0.93L;
+            u = ((u < 0.L) ? -0.5L : 0.5L) - u;
+            v = mt_real1(mt) * vr;
+        }
+
+        us = 0.5L - fabsl(u);
+        k  = floorl((2.L*a/us + b)*u + c);
+        if(k < 0.L || k > n)
+            continue;
+        v  = v*alpha / (a/(us*us) + b);
+        km = fabsl(k - m);
+
+        // Close to the mode the ratio of the probabilities is evaluated recursively
+        if(km <= 15.L) {
+            f = 1.L;
+            if(m < k) {
+                for(ldouble i = m+1.L; i <= k; ++i)
+                    f *= nr/i - r;
+            } else if(m > k) {
+                for(ldouble i = k+1.L; i <= m; ++i)
+                    v *= nr/i - r;
+            }
+            if(v <= f)
+                return (ullong) k;
+            continue;
+        }
+
+        v   = logl(v);
+        rho = (km/npq) * (((km/3.L + 0.625L)*km + 1.L/6.L)/npq + 0.5L);
+        t   = -km*km / (2.L*npq);
+        if(v < t - rho)
+            return (ullong) k;
+        if(v > t + rho)
+            continue;
+
+        nm = n - m + 1.L;
+        h  = (m + 0.5L)*logl((m + 1.L)/(r*nm)) + binom_fc((ullong) m) + binom_fc(n - (ullong) m);
+        nk = n - k + 1.L;
+        if(v <= h + (n+1.L)*logl(nm/nk) + (k + 0.5L)*logl(nk*r/(k + 1.L)) -
+                binom_fc((ullong) k) - binom_fc(n - (ullong) k))
+            return (ullong) k;
+    }
+}
+
+ullong binom(mt_t* mt, ullong n, ldouble p) {
+    if(n == 0 || p <= 0.L)
+        return 0;
+    if(p >= 1.L)
+        return n;
+    if(p > 0.5L)
+        return n - binom(mt, n, 1.L - p);
+
+    return (n*p < 10.L) ? binom_inversion(mt, n, p) : binom_btrd(mt, n, p);
+}
+
+void mbinom(mt_t* mt, ullong* destdist, ldouble* probs, ullong ncolors, ullong n) {
+    ldouble rest = 1.L;
+    for(ullong c = 0; c < ncolors; ++c) {
+        ldouble p = (probs != NULL) ? probs[c] : 1.L / ncolors;
+        destdist[c] = (c == ncolors-1) ? n : binom(mt, n, (rest > p) ? p / rest : 1.L);
+        n    -= destdist[c];
+        rest -= p;
+    }
+}
+
+/*
+ *  State of mhgeom_pairs shared by all blocks, where rpre holds the prefix sums of the rows and
+ *  cpre is the scratch space for the prefix sums of the columns of the block being split.
+ */
+typedef struct pairs_t {
+    mt_t*   mt;
+    ullong* rows;
+    ullong* rpre;
+    ullong* cpre;
+    ullong  ncols;
+    void  (*emit)(ullong, ullong, ullong, void*);
+    void*   arg;
+} pairs_t;
+
+/*
+ *  Samples the share dest of the columns cnt in [lo,hi) of size sample by binary splitting, where
+ *  the prefix sums of cnt are in cpre.
+ */
+static void pairs_split(pairs_t* s, ullong* dest, ullong* cnt, ullong lo, ullong hi,
+                        ullong sample) {
+    ullong total = s->cpre[hi] - s->cpre[lo];
+    if(sample == 0) {
+        for(ullong k = lo; k < hi; ++k)
+            dest[k] = 0;
+    } else if(sample == total) {
+        for(ullong k = lo; k < hi; ++k)
+            dest[k] = cnt[k];
+    } else if(hi-lo == 1) {
+        dest[lo] = sample;
+    } else {
+        ullong mi = lo + (hi-lo)/2;
+        ullong x  = hgeom(s->mt, total, s->cpre[mi] - s->cpre[lo], sample);
+        pairs_split(s, dest, cnt, lo, mi, x);
+        pairs_split(s, dest, cnt, mi, hi, sample-x);
+    }
+}
+
+/*
+ *  Pairs the rows in [a,b) with the len non-empty columns idx of counts cnt, where the columns of
+ *  the second half of the rows are kept in place and the first half gets the next two buffers of
+ *  ncols elements of the workspace free.
+ */
+static void pairs_block(pairs_t* s, ullong a, ullong b, ullong* idx, ullong* cnt, ullong len,
+                        ullong* free) {
+    for(;;) {
+        ullong m = s->rpre[b] - s->rpre[a];
+        if(m == 0 || len == 0)
+            return;
+        if(b-a == 1) {
+            for(ullong k = 0; k < len; ++k)
+                (*s->emit)(a, idx[k], cnt[k], s->arg);
+            return;
+        }
+        if(len == 1) {
+            for(ullong i = a; i < b; ++i)
+                if(s->rows[i] > 0)
+                    (*s->emit)(i, idx[0], s->rows[i], s->arg);
+            return;
+        }
+
+        ullong mi = a + (b-a)/2;
+        ullong m1 = s->rpre[mi] - s->rpre[a];
+        if(m1 == 0) { a = mi; continue; }
+        if(m1 == m) { b = mi; continue; }
+
+        ullong* nidx = free;
+        ullong* ncnt = free + s->ncols;
+        s->cpre[0] = 0;
+        for(ullong k = 0; k < len; ++k)
+            s->cpre[k+1] = s->cpre[k] + cnt[k];
+        pairs_split(s, ncnt, cnt, 0, len, m1);
+
+        // Both shares are compacted, where the first one never overtakes the position read
+        ullong n1 = 0, n2 = 0, x;
+        for(ullong k = 0; k < len; ++k) {
+            x       = ncnt[k];
+            cnt[k] -= x;
+            if(x > 0) {
+                nidx[n1]   = idx[k];
+                ncnt[n1++] = x;
+            }
+            if(cnt[k] > 0) {
+                idx[n2]   = idx[k];
+                cnt[n2++] = cnt[k];
+            }
+        }
+
+        pairs_block(s, a, mi, nidx, ncnt, n1, free + 2*s->ncols);
+        a   = mi;
+        len = n2;
+    }
+}
+
+ullong mhgeom_pairs_work(ullong nrows, ullong ncols) {
+    // Only the first halves descend into new buffers, i.e. at most ceil(log2(nrows)) times
+    ullong depth = 0;
+    while((1LLU << depth) < nrows && depth < 63)
+        depth++;
+    return (nrows+1) + (ncols+1) + 2*ncols*(depth+1);
+}
+
+void mhgeom_pairs(mt_t* mt, ullong* rows, ullong nrows, ullong* cols, ullong ncols, ullong* work,
+                  void (*emit)(ullong i, ullong j, ullong x, void* arg), void* arg) {
+    pairs_t s;
+    s.mt    = mt;
+    s.rows  = rows;
+    s.rpre  = work;
+    s.cpre  = work + (nrows+1);
+    s.ncols = ncols;
+    s.emit  = emit;
+    s.arg   = arg;
+
+    s.rpre[0] = 0;
+    for(ullong i = 0; i < nrows; ++i)
+        s.rpre[i+1] = s.rpre[i] + rows[i];
+
+    ullong* idx = s.cpre + (ncols+1);
+    ullong* cnt = idx + ncols;
+    ullong  len = 0;
+    for(ullong j = 0; j < ncols; ++j) {
+        if(cols[j] > 0) {
+            idx[len]   = j;
+            cnt[len++] = cols[j];
+        }
+    }
+    pairs_block(&s, 0, nrows, idx, cnt, len, cnt + ncols);
+}
@@ -0,0 +1,118 @@
+/*
+ *      Filename: ktab.c
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "ktab.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+
+ktab_t* ktab_create(ullong nstates, ullong k, ullong max_ntrans) {
+    if(nstates == ULLONG_MAX || k < 2 || k > KTAB_MAXK) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    ktab_t* t = (ktab_t*) calloc(1, sizeof(ktab_t));
+    if(t == NULL) return NULL;
+
+    t->nstates    = nstates;
+    t->k          = k;
+    t->ntrans     = 0;
+    t->max_ntrans = max_ntrans;
+
+    ullong size = (max_ntrans > 0 ? max_ntrans : 1) * k;
+    if((t->key = (ullong*) malloc(size * sizeof(ullong))) == NULL ||
+            (t->val = (ullong*) malloc(size * sizeof(ullong))) == NULL) {
+        ktab_destroy(t);
+        return NULL;
+    }
+
+    return t;
+}
+
+int ktab_insert(ktab_t* t, ullong* key, ullong* val) {
+    if(memcmp(key, val, t->k * sizeof(ullong)) == 0)
+        return 1;
+    if(t->ntrans >= t->max_ntrans)
+        return 0;
+
+    memcpy(t->key + t->ntrans*t->k, key, t->k * sizeof(ullong));
+    memcpy(t->val + t->ntrans*t->k, val, t->k * sizeof(ullong));
+    t->ntrans++;
+    return 1;
+}
+
+int ktab_build(ktab_t* t) {
+    ullong n = t->ntrans, k = t->k;
+    ullong* idx = (ullong*) malloc((n > 0 ? n : 1) * sizeof(ullong));
+    ullong* tmp = (ullong*) malloc((n > 0 ? n : 1) * sizeof(ullong));
+    ullong* cnt = (ullong*) malloc((t->nstates+1) * sizeof(ullong));
+    ullong* key = (ullong*) malloc((n > 0 ? n : 1) * k * sizeof(ullong));
+    ullong* val = (ullong*) malloc((n > 0 ? n : 1) * k * sizeof(ullong));
+    if(idx == NULL || tmp == NULL || cnt == NULL || key == NULL || val == NULL) {
+        free(idx); free(tmp); free(cnt); free(key); free(val);
+        return 0;
+    }
+
+    // Stable counting sorts from the last position to the first yield the lexicographic order,
+    // where equal keys stay in the order of insertion
+    for(ullong i = 0; i < n; ++i)
+        idx[i] = i;
+    ullong* swap;
+    for(ullong pos = k; pos > 0; --pos) {
+        memset(cnt, 0, (t->nstates+1) * sizeof(ullong));
+        for(ullong i = 0; i < n; ++i)
+            cnt[t->key[idx[i]*k + pos-1]+1]++;
+        for(ullong s = 0; s < t->nstates; ++s)
+            cnt[s+1] += cnt[s];
+        for(ullong i = 0; i < n; ++i)
+            tmp[cnt[t->key[idx[i]*k + pos-1]]++] = idx[i];
+        swap = idx; idx = tmp; tmp = swap;
+    }
+
+    ullong m = 0;
+    for(ullong i = 0; i < n; ++i) {
+        ullong* ki = t->key + idx[i]*k;
+        if(m > 0 && memcmp(key + (m-1)*k, ki, k * sizeof(ullong)) == 0)
+            continue;
+        memcpy(key + m*k, ki, k * sizeof(ullong));
+        memcpy(val + m*k, t->val + idx[i]*k, k * sizeof(ullong));
+        m++;
+    }
+
+    free(t->key); free(t->val);
+    t->key    = key;
+    t->val    = val;
+    t->ntrans = m;
+
+    free(idx); free(tmp); free(cnt);
+    return 1;
+}
+
+int ktab_silent(ktab_t* t, ullong* dist) {
+    for(ullong i = 0; i < t->ntrans; ++i) {
+        ullong* key = ktab_key(t, i);
+        int applies = 1;
+        // Every state of the key needs as many agents as it occurs in the key
+        for(ullong pos = 0; pos < t->k && applies; ++pos) {
+            ullong mult = 0;
+            for(ullong c = 0; c < t->k; ++c)
+                mult += (key[c] == key[pos]);
+            applies = dist[key[pos]] >= mult;
+        }
+        if(applies)
+            return 0;
+    }
+    return 1;
+}
+
+void ktab_destroy(ktab_t* t) {
+    free(t->key);
+    free(t->val);
+    free(t);
+}
@@ -11,277 +11,2807 @@
 #include "aliurn.h"
 #include "coll.h"
 #include "hgeom.h"
+#include "trtab.h"
+#include "ktab.h"
+#include "snap.h"
+#include "graph.h"
+#include "stats.h"
 
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #define POPSIM_MIN(x,y) ((x) <= (y) ? (x) : (y))
 #define POPSIM_MAX(x,y) ((x) >= (y) ? (x) : (y))
 
+// Engines of the hybrid simulator, the number of rounds after which the slower one is tried again
+// and the minimum number of sequential steps per round
+#define HYBRID_SEQ      0
+#define HYBRID_BATCH    1
+#define HYBRID_PROBE    16
+#define HYBRID_MINCHUNK 256
+
+// Leaps shorter than this many interactions are replaced by exact sequential steps since the
+// drift estimate of a leap costs as much as its batch phase
+#define LEAP_MINLEAP 64
+
+// Replicas advanced at once by the lock-step simulator and the maximum number of steps between
+// two checks of their stop conditions
+#define LOCK_W     16
+#define LOCK_CHECK 16
+
+// Initial step in parallel time of the mean-field simulator and the bounds of the factor by
+// which the step changes after each step
+#define ODE_H0      0.01L
+#define ODE_MINFAC  0.2L
+#define ODE_MAXFAC  5.L
+
 typedef struct timespec timespec;
 
-void popsim_seqarr(arrurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                   void (*delta)(ullong, ullong, ullong*, ullong*)) {
+// Whether an interaction (p1,q1)->(p2,q2) changed the configuration
+#define POPSIM_CHANGED(p1,q1,p2,q2) \
+    (!(((p1) == (p2) && (q1) == (q2)) || ((p1) == (q2) && (q1) == (p2))))
+
+int popsim_stopcond(popsim_stop_t* stop, ullong* dist, ullong nstates) {
+    if(stop->silent != NULL && trtab_silent(stop->silent, dist))
+        return 1;
+    if(stop->ksilent != NULL && ktab_silent(stop->ksilent, dist))
+        return 1;
+
+    if(stop->set != NULL) {
+        ullong q = 0;
+        for(ullong i = 0; i < stop->nset; ++i)
+            q += dist[stop->set[i]];
+        if(q == stop->nagents)
+            return 1;
+    }
+
+    return stop->pred != NULL && (*stop->pred)(dist, nstates, stop->arg);
+}
+
+/*
+ *  Checks the stop condition on the initial configuration and returns non-zero if it holds.
+ */
+static int stop_init(popsim_stop_t* stop, ullong* dist, ullong nstates) {
+    if(stop == NULL)
+        return 0;
+
+    stop->nagents = 0;
+    for(ullong s = 0; s < nstates; ++s)
+        stop->nagents += dist[s];
+
+    stop->step    = 0;
+    stop->stopped = popsim_stopcond(stop, dist, nstates);
+    return stop->stopped;
+}
+
+/*
+ *  Checks the stop condition after step interactions and returns non-zero if it holds.
+ */
+static inline int stop_check(popsim_stop_t* stop, ullong* dist, ullong nstates, ullong step) {
+    if(stop == NULL || popsim_stopcond(stop, dist, nstates) == 0)
+        return 0;
+
+    stop->stopped = 1;
+    stop->step    = step;
+    return 1;
+}
+
+static inline void stop_end(popsim_stop_t* stop, ullong step) {
+    if(stop != NULL && stop->stopped == 0)
+        stop->step = step;
+}
+
+void popsim_seqarr(arrurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop) {
+    ullong nconf = snap_nsnap(snap);
     arrurn_dist(u, conf);
-    ullong cstep = nsteps / nconf;
+    // The counts are only kept for the stop condition, where the last snapshot is used for them
+    ullong* dist = conf + nconf*nstates;
+    if(stop != NULL)
+        memcpy(dist, conf, nstates * sizeof(ullong));
+
     ullong p1, q1, p2, q2;
-    for(ullong i = 1, j = 1; i <= nsteps; ++i) {
+    ullong i, j = 1;
+    int stopped = stop_init(stop, dist, nstates);
+    for(i = 1; i <= nsteps && !stopped; ++i) {
         p1 = arrurn_draw(u); q1 = arrurn_draw(u); 
         (*delta)(p1, q1, &p2, &q2); 
         arrurn_cinsert(u, p2, 1); arrurn_cinsert(u, q2, 1);
 
-        if(j < nconf && i == j*cstep)
+        if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2)) {
+            dist[p1]--; dist[q1]--; dist[p2]++; dist[q2]++;
+            stopped = stop_check(stop, dist, nstates, i);
+        }
+
+        if(j < nconf && i == snap_step(snap, j))
             arrurn_dist(u, conf + (j++)*nstates);
     }
-    arrurn_dist(u, conf + nconf*nstates);
+    stop_end(stop, i-1);
+
+    if(stop != NULL) {
+        while(j < nconf)
+            memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+    } else {
+        arrurn_dist(u, dist);
+    }
 }
 
-void popsim_seqlin(linurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                   void (*delta)(ullong, ullong, ullong*, ullong*)) {
+void popsim_seqlin(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop) {
+    ullong nconf = snap_nsnap(snap);
     memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
-    ullong cstep = nsteps / nconf;
     ullong p1, q1, p2, q2;
-    for(ullong i = 1, j = 1; i <= nsteps; ++i) {
+    ullong i, j = 1;
+    int stopped = stop_init(stop, linurn_dist(u), nstates);
+    for(i = 1; i <= nsteps && !stopped; ++i) {
         p1 = linurn_draw(u); q1 = linurn_draw(u); 
         (*delta)(p1, q1, &p2, &q2); 
         linurn_cinsert(u, p2, 1); linurn_cinsert(u, q2, 1);
 
-        if(j < nconf && i == j*cstep)
+        if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2))
+            stopped = stop_check(stop, linurn_dist(u), nstates, i);
+
+        if(j < nconf && i == snap_step(snap, j))
             memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
     }
-    memcpy(conf + nconf*nstates, linurn_dist(u), nstates * sizeof(ullong));
+    stop_end(stop, i-1);
+
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
 }
 
-void popsim_seqbst(bsturn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                   void (*delta)(ullong, ullong, ullong*, ullong*)) {
+void popsim_seqbst(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop) {
+    ullong nconf = snap_nsnap(snap);
     memcpy(conf, bsturn_dist(u), nstates * sizeof(ullong));
-    ullong cstep = nsteps / nconf;
     ullong p1, q1, p2, q2;
-    for(ullong i = 1, j = 1; i <= nsteps; ++i) {
+    ullong i, j = 1;
+    int stopped = stop_init(stop, bsturn_dist(u), nstates);
+    for(i = 1; i <= nsteps && !stopped; ++i) {
         p1 = bsturn_draw(u); q1 = bsturn_draw(u); 
         (*delta)(p1, q1, &p2, &q2); 
         bsturn_cinsert(u, p2, 1); bsturn_cinsert(u, q2, 1);
 
-        if(j < nconf && i == j*cstep)
+        if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2))
+            stopped = stop_check(stop, bsturn_dist(u), nstates, i);
+
+        if(j < nconf && i == snap_step(snap, j))
             memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
     }
-    memcpy(conf + nconf*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+    stop_end(stop, i-1);
+
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+}
+
+int popsim_seqbsti(bsturn_t** u, ullong nreps, ullong nsteps, ullong nstates, snap_t* snap,
+                   ullong** conf, void (*delta)(ullong, ullong, ullong*, ullong*),
+                   popsim_stop_t* stop) {
+    if(nreps > BSTURN_MAXDRAW) {
+        errno = EDOM;
+        return 0;
+    }
+
+    // The running replicas are kept in front of act, where idx maps them to their index in u and
+    // jr holds the next snapshot of every replica
+    bsturn_t* act[BSTURN_MAXDRAW];
+    ullong idx[BSTURN_MAXDRAW], jr[BSTURN_MAXDRAW];
+    ullong p1[BSTURN_MAXDRAW], q1[BSTURN_MAXDRAW], p2[BSTURN_MAXDRAW], q2[BSTURN_MAXDRAW];
+    ullong nconf = snap_nsnap(snap);
+    ullong nact  = 0;
+    for(ullong r = 0; r < nreps; ++r) {
+        memcpy(conf[r], bsturn_dist(u[r]), nstates * sizeof(ullong));
+        jr[r] = 1;
+        if(stop_init(stop != NULL ? stop+r : NULL, bsturn_dist(u[r]), nstates) == 0) {
+            act[nact]   = u[r];
+            idx[nact++] = r;
+        }
+    }
+
+    ullong i, j = 1;
+    for(i = 1; i <= nsteps && nact > 0; ++i) {
+        bsturn_mdraw(act, nact, p1);
+        bsturn_mdraw(act, nact, q1);
+
+        // The leaves are fetched for all replicas before the first ascent of any
+        for(ullong r = 0; r < nact; ++r) {
+            (*delta)(p1[r], q1[r], p2+r, q2+r);
+            __builtin_prefetch(bsturn_dist(act[r]) + p2[r], 1);
+            __builtin_prefetch(bsturn_dist(act[r]) + q2[r], 1);
+        }
+        bsturn_minsert(act, nact, p2);
+        bsturn_minsert(act, nact, q2);
+
+        // A stopped replica is replaced by the last running one
+        for(ullong r = 0; stop != NULL && r < nact; ++r) {
+            if(POPSIM_CHANGED(p1[r], q1[r], p2[r], q2[r]) &&
+                    stop_check(stop+idx[r], bsturn_dist(act[r]), nstates, i)) {
+                jr[idx[r]] = j;
+                nact--;
+                act[r] = act[nact]; idx[r] = idx[nact];
+                p1[r]  = p1[nact];  q1[r]  = q1[nact];
+                p2[r]  = p2[nact];  q2[r]  = q2[nact];
+                r--;
+            }
+        }
+
+        if(j < nconf && i == snap_step(snap, j)) {
+            for(ullong r = 0; r < nact; ++r)
+                memcpy(conf[idx[r]] + j*nstates, bsturn_dist(act[r]), nstates * sizeof(ullong));
+            j++;
+        }
+    }
+
+    for(ullong r = 0; r < nact; ++r)
+        jr[idx[r]] = j;
+    for(ullong r = 0; r < nreps; ++r) {
+        stop_end(stop != NULL ? stop+r : NULL, i-1);
+        for(ullong k = jr[r]; k <= nconf; ++k)
+            memcpy(conf[r] + k*nstates, bsturn_dist(u[r]), nstates * sizeof(ullong));
+    }
+    return 1;
+}
+
+/*
+ *  Runs the trajectory w from step i until the level of its configuration reaches thresh, which
+ *  returns the step of the crossing, or the stop condition holds or all nsteps steps are taken,
+ *  which returns ULLONG_MAX.
+ */
+static ullong split_run(bsturn_t* w, ullong i, ullong nsteps, ullong nstates,
+                        void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop,
+                        popsim_split_t* sp, ldouble thresh) {
+    if((*sp->level)(bsturn_dist(w), nstates, sp->arg) >= thresh)
+        return i;
+
+    ullong p1, q1, p2, q2;
+    while(i < nsteps) {
+        p1 = bsturn_draw(w); q1 = bsturn_draw(w);
+        (*delta)(p1, q1, &p2, &q2);
+        bsturn_cinsert(w, p2, 1); bsturn_cinsert(w, q2, 1);
+        i++;
+
+        if(POPSIM_CHANGED(p1, q1, p2, q2)) {
+            if((*sp->level)(bsturn_dist(w), nstates, sp->arg) >= thresh)
+                return i;
+            if(stop != NULL && popsim_stopcond(stop, bsturn_dist(w), nstates))
+                return ULLONG_MAX;
+        }
+    }
+    return ULLONG_MAX;
+}
+
+/*
+ *  Runs a single splitting of ntraj trajectories per stage from u and adds the number of started
+ *  trajectories and crossings of every stage to nrun and ncross. Returns the estimated
+ *  probability or a negative value if there was not enough memory.
+ */
+static ldouble split_batch(bsturn_t* u, ullong nsteps, ullong nstates,
+                           void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop,
+                           popsim_split_t* sp, ullong ntraj, ullong* nrun, ullong* ncross,
+                           mt_t* mt) {
+    // The entry states of a stage are the urns and steps of the trajectories which crossed the
+    // previous level, where the first stage starts every trajectory from u
+    bsturn_t** start = (bsturn_t**) malloc(ntraj * sizeof(bsturn_t*));
+    bsturn_t** succ  = (bsturn_t**) malloc(ntraj * sizeof(bsturn_t*));
+    ullong* sstep = (ullong*) malloc(ntraj * sizeof(ullong));
+    ullong* nstep = (ullong*) malloc(ntraj * sizeof(ullong));
+    if(start == NULL || succ == NULL || sstep == NULL || nstep == NULL) {
+        free(start); free(succ); free(sstep); free(nstep);
+        return -1.L;
+    }
+
+    ullong nstart = 1, nsucc = 0, off, i;
+    ldouble prob = 1.L;
+    start[0] = u;
+    sstep[0] = 0;
+    for(ullong k = 0; k < sp->nlevels && nstart > 0; ++k) {
+        // Every entry state is cloned about ntraj/nstart times, where a random offset decides
+        // which ones get one clone more
+        nsucc    = 0;
+        off      = mt_urand(mt, nstart);
+        nrun[k] += ntraj;
+        for(ullong j = 0; j < ntraj && prob >= 0.L; ++j) {
+            ullong src = (j+off) % nstart;
+            bsturn_t* w = bsturn_copy(start[src], mt_rand(mt));
+            if(w == NULL)
+                prob = -1.L;
+            else if((i = split_run(w, sstep[src], nsteps, nstates, delta, stop, sp,
+                                   sp->thresh[k])) == ULLONG_MAX)
+                bsturn_destroy(w);
+            else {
+                succ[nsucc]    = w;
+                nstep[nsucc++] = i;
+            }
+        }
+
+        for(ullong j = 0; j < nstart; ++j)
+            if(start[j] != u)
+                bsturn_destroy(start[j]);
+        bsturn_t** tu = start; start = succ; succ = tu;
+        ullong*    ts = sstep; sstep = nstep; nstep = ts;
+        nstart = nsucc;
+        if(prob < 0.L)
+            break;
+
+        ncross[k] += nsucc;
+        prob      *= nsucc / (ldouble) ntraj;
+    }
+
+    for(ullong j = 0; j < nstart; ++j)
+        bsturn_destroy(start[j]);
+    free(start); free(succ); free(sstep); free(nstep);
+    return prob;
+}
+
+int popsim_split(bsturn_t* u, ullong nsteps, ullong nstates,
+                 void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop,
+                 popsim_split_t* sp, ullong seed) {
+    ullong nbatch = sp->nbatch;
+    if(nbatch < 2 || sp->ntraj < nbatch || sp->nlevels == 0) {
+        errno = EDOM;
+        return 0;
+    }
+    ullong* nrun = (ullong*) calloc(2*sp->nlevels, sizeof(ullong));
+    if(nrun == NULL)
+        return 0;
+    ullong* ncross = nrun + sp->nlevels;
+    stop_init(stop, bsturn_dist(u), nstates);
+
+    mt_t mt;
+    mt_init(&mt, seed);
+    ldouble pb, sum = 0.L, sqsum = 0.L;
+    for(ullong b = 0; b < nbatch; ++b) {
+        // The trajectories are spread evenly over the batches
+        ullong ntraj = sp->ntraj/nbatch + (b < sp->ntraj % nbatch);
+        if((pb = split_batch(u, nsteps, nstates, delta, stop, sp, ntraj, nrun, ncross,
+                             &mt)) < 0.L) {
+            free(nrun);
+            return 0;
+        }
+        sum   += pb;
+        sqsum += pb*pb;
+    }
+
+    ldouble t   = stats_tquant(nbatch-1);
+    ldouble var = (sqsum - sum*sum/nbatch) / (nbatch-1);
+    sp->prob = sum / nbatch;
+    sp->lo   = sp->prob - t * sqrtl(POPSIM_MAX(var, 0.L) / nbatch);
+    sp->hi   = sp->prob + t * sqrtl(POPSIM_MAX(var, 0.L) / nbatch);
+    sp->lo   = POPSIM_MAX(sp->lo, 0.L);
+
+    // The fractions of a stage are pooled over the batches that reached it. If no batch crossed
+    // every level, then the first empty stage bounds the probability by the rule of three
+    for(ullong k = 0; k < sp->nlevels; ++k)
+        sp->cond[k] = (nrun[k] > 0) ? ncross[k] / (ldouble) nrun[k] : 0.L;
+    if(sp->prob == 0.L) {
+        sp->hi = 1.L;
+        for(ullong k = 0; k < sp->nlevels && ncross[k] > 0; ++k)
+            sp->hi *= sp->cond[k];
+        for(ullong k = 0; k < sp->nlevels; ++k) {
+            if(ncross[k] == 0) {
+                sp->hi *= 3.L / nrun[k];
+                break;
+            }
+        }
+    }
+    free(nrun);
+    return 1;
 }
 
-void popsim_seqali(aliurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                   void (*delta)(ullong, ullong, ullong*, ullong*)) {
+void popsim_seqali(aliurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop) {
+    ullong nconf = snap_nsnap(snap);
     aliurn_dist(u, conf);
-    ullong cstep = nsteps / nconf;
+    // The counts are only kept for the stop condition, where the last snapshot is used for them
+    ullong* dist = conf + nconf*nstates;
+    if(stop != NULL)
+        memcpy(dist, conf, nstates * sizeof(ullong));
+
     ullong p1, q1, p2, q2;
-    for(ullong i = 1, j = 1; i <= nsteps; ++i) {
+    ullong i, j = 1;
+    int stopped = stop_init(stop, dist, nstates);
+    for(i = 1; i <= nsteps && !stopped; ++i) {
         p1 = aliurn_draw(u); q1 = aliurn_draw(u); 
         (*delta)(p1, q1, &p2, &q2); 
         aliurn_cinsert(u, p2, 1); aliurn_cinsert(u, q2, 1);
 
-        if(j < nconf && i == j*cstep)
+        if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2)) {
+            dist[p1]--; dist[q1]--; dist[p2]++; dist[q2]++;
+            stopped = stop_check(stop, dist, nstates, i);
+        }
+
+        if(j < nconf && i == snap_step(snap, j))
             aliurn_dist(u, conf + (j++)*nstates);
     }
-    aliurn_dist(u, conf + nconf*nstates);
+    stop_end(stop, i-1);
+
+    if(stop != NULL) {
+        while(j < nconf)
+            memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+    } else {
+        aliurn_dist(u, dist);
+    }
 }
 
-int popsim_batch(linurn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                 void (*delta)(ullong, ullong, ullong*, ullong*),
-                 ullong seed1, ullong seed2, ullong seed3) {
-    linurn_t* un = linurn_create(seed1, nstates);
-    if(un == NULL) return 0;
+/*
+ *  Draws an integer in [0,n) from x by a multiplication, where draws falling below the threshold
+ *  t = 2^64 mod n are redrawn such that the result stays uniform (Lemire).
+ */
+static inline ullong small_urand(mt_t* mt, ullong x, ullong n, ullong t) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 m = (unsigned __int128) x * n;
+    while((ullong) m < t) {
+        x = mt_rand(mt);
+        m = (unsigned __int128) x * n;
+    }
+    return (ullong) (m >> 64);
+#else
+    (void) t;
+    return mt_urand(mt, n);
+#endif
+}
 
-    ullong* ic = (ullong*) malloc(nstates * sizeof(ullong));
-    if(ic == NULL) return 0;
-    ullong* rc = (ullong*) malloc(nstates * sizeof(ullong));
-    if(rc == NULL) return 0;
+/*
+ *  Same as small_urand for 32 bit draws x and n < 2^32 with t = 2^32 mod n, such that a single 64
+ *  bit random number serves two draws.
+ */
+static inline ullong small_urand32(mt_t* mt, ullong x, ullong n, ullong t) {
+    ullong m = x * n;
+    while((m & 0xFFFFFFFFLLU) < t)
+        m = (mt_rand(mt) >> 32) * n;
+    return m >> 32;
+}
 
-    ullong p1, p2;
-    ullong q1, q2;
-    
-    ullong l;
-    coll_t c;
-    coll_seed(&c, seed2);
-    coll_setnr(&c, linurn_nmarbles(u), 0);
+/*
+ *  Runs the steps of popsim_seqsmall with NS states, where the counts are kept in c and both
+ *  agents of an interaction are drawn from the population of n agents without replacement, i.e.
+ *  the responder from the n-1 remaining ones.
+ */
+#define SMALL_RUN(NS) do { \
+    ullong c[NS] = {0}; \
+    ubyte  tab[2*NS*NS]; \
+    memcpy(c, linurn_dist(u), nstates * sizeof(ullong)); \
+    for(ullong p = 0; p < NS; ++p) { \
+        for(ullong q = 0; q < NS; ++q) { \
+            p2 = p; q2 = q; \
+            if(p < nstates && q < nstates) \
+                (*delta)(p, q, &p2, &q2); \
+            tab[2*(p*NS+q)] = p2; tab[2*(p*NS+q)+1] = q2; \
+        } \
+    } \
+    memcpy(conf, c, nstates * sizeof(ullong)); \
+    \
+    stopped = stop_init(stop, c, nstates); \
+    for(i = 1; i <= nsteps && !stopped; ++i) { \
+        if(narrow) { \
+            x = mt_rand(&mt); \
+            y = small_urand32(&mt, x & 0xFFFFFFFFLLU, n-1, t2); \
+            x = small_urand32(&mt, x >> 32, n, t1); \
+        } else { \
+            x = small_urand(&mt, mt_rand(&mt), n, t1); \
+            y = small_urand(&mt, mt_rand(&mt), n-1, t2); \
+        } \
+        p1 = 0; acc = 0; \
+        for(ullong s = 0; s < NS-1; ++s) { \
+            acc += c[s]; \
+            p1  += (x >= acc); \
+        } \
+        c[p1]--; \
+        q1 = 0; acc = 0; \
+        for(ullong s = 0; s < NS-1; ++s) { \
+            acc += c[s]; \
+            q1  += (y >= acc); \
+        } \
+        c[p1]++; \
+        \
+        p2 = tab[2*(p1*NS+q1)]; q2 = tab[2*(p1*NS+q1)+1]; \
+        if(p2 != p1 || q2 != q1) { \
+            c[p1]--; c[q1]--; c[p2]++; c[q2]++; \
+            if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2)) \
+                stopped = stop_check(stop, c, nstates, i); \
+        } \
+        if(j < nconf && i == snap_step(snap, j)) \
+            memcpy(conf + (j++)*nstates, c, nstates * sizeof(ullong)); \
+    } \
+    stop_end(stop, i-1); \
+    while(j <= nconf) \
+        memcpy(conf + (j++)*nstates, c, nstates * sizeof(ullong)); \
+    linurn_empty(u); \
+    linurn_insert(u, c); \
+} while(0)
+
+int popsim_seqsmall(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                    void (*delta)(ullong, ullong, ullong*, ullong*), popsim_stop_t* stop,
+                    ullong seed) {
+    if(nstates > POPSIM_SMALL_MAX) {
+        errno = EDOM;
+        return 0;
+    }
 
     mt_t mt;
-    mt_init(&mt, seed3);
+    mt_init(&mt, seed);
 
-    memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
-    ullong cstep = nsteps / nconf;
-    ullong j = 1;
-    for(ullong i = 1; i <= nsteps;) {
-        do {
-            l = coll_coll(&c); 
-        } while(l < 2);
+    // The thresholds of the rejection of both draws only depend on the number of agents, where
+    // less than 2^32 agents allow for both draws from one random number
+    ullong nconf  = snap_nsnap(snap);
+    ullong n      = linurn_nmarbles(u);
+    int    narrow = (n <= 0xFFFFFFFFLLU);
+    ullong t1 = narrow ? (0x100000000LLU % n) : (0-n) % n;
+    ullong t2 = narrow ? (0x100000000LLU % (n-1)) : (0-(n-1)) % (n-1);
+    ullong x, y, acc, p1, q1, p2, q2;
+    ullong i, j = 1;
+    int stopped;
+    if(nstates <= 4)
+        SMALL_RUN(4);
+    else if(nstates <= 8)
+        SMALL_RUN(8);
+    else
+        SMALL_RUN(16);
+    return 1;
+}
 
-        mhgeom(&mt, ic, linurn_dist(u), nstates, linurn_nmarbles(u), l/2);
-        linurn_remove(u, ic);
-        for(p1 = 0; p1 < nstates; ++p1) {
-            mhgeom(&mt, rc, linurn_dist(u), nstates, linurn_nmarbles(u), ic[p1]);
-            linurn_remove(u, rc);
+/*
+ *  Group of LOCK_W replicas advanced in lock-step in a structure of arrays layout, where the count
+ *  of state s in lane l is cnt[s*LOCK_W+l] and every lane has its own xoshiro128** generator s.
+ *  Lanes which stopped or pad the last group are frozen by a zero in active. Every entry of tab
+ *  holds both states a pair of states is mapped to by delta in its lower and upper half.
+ */
+typedef struct lgroup_t {
+    ullong nstates;
+    uint   n, t1, t2;
+    uint*  tab;
+    uint*  cnt;
+    uint   s[4][LOCK_W];
+    uint   active[LOCK_W];
+} lgroup_t;
 
-            for(q1 = 0; q1 < nstates; ++q1) {
-                (*delta)(p1, q1, &p2, &q2); 
-                linurn_cinsert(un, p2, rc[q1]);
-                linurn_cinsert(un, q2, rc[q1]);
+static inline uint lock_rotl(uint x, int k) {
+    return (x << k) | (x >> (32-k));
+}
+
+static inline uint lock_next(lgroup_t* g, ullong l) {
+    uint r = lock_rotl(g->s[1][l] * 5, 7) * 9;
+    uint t = g->s[1][l] << 9;
+    g->s[2][l] ^= g->s[0][l];
+    g->s[3][l] ^= g->s[1][l];
+    g->s[1][l] ^= g->s[2][l];
+    g->s[0][l] ^= g->s[3][l];
+    g->s[2][l] ^= t;
+    g->s[3][l]  = lock_rotl(g->s[3][l], 11);
+    return r;
+}
+
+/*
+ *  Bounds the draw r to [0,n) by a multiplication, where draws whose lower half falls below
+ *  t = 2^32 mod n are redrawn from lane l (Lemire).
+ */
+static inline uint lock_bound(lgroup_t* g, ullong l, uint r, uint n, uint t) {
+    ullong m = (ullong) r * n;
+    while((uint) m < t)
+        m = (ullong) lock_next(g, l) * n;
+    return m >> 32;
+}
+
+/*
+ *  Single step of lane l. The vectorised kernels follow the same order of draws, such that every
+ *  lane runs exactly the same steps regardless of the kernel.
+ */
+static void lock_step(lgroup_t* g, ullong l) {
+    uint* c = g->cnt + l;
+    ullong ns = g->nstates;
+    uint r1 = lock_next(g, l), r2 = lock_next(g, l);
+    uint x = lock_bound(g, l, r1, g->n, g->t1);
+    uint y = lock_bound(g, l, r2, g->n-1, g->t2);
+
+    uint p = 0, q = 0, acc = 0, s;
+    for(s = 0; s < ns-1; ++s) {
+        acc += c[s*LOCK_W];
+        p   += (x >= acc);
+    }
+    acc = 0;
+    for(s = 0; s < ns-1; ++s) {
+        acc += c[s*LOCK_W];
+        q   += (y >= acc - (s >= p));
+    }
+
+    uint e = g->tab[p*ns+q];
+    if(g->active[l] && (e & 0xFFFF) != p) {
+        c[p*LOCK_W]--; c[(e & 0xFFFF)*LOCK_W]++;
+    }
+    if(g->active[l] && (e >> 16) != q) {
+        c[q*LOCK_W]--; c[(e >> 16)*LOCK_W]++;
+    }
+}
+
+static void lock_scalar(lgroup_t* g, ullong nsteps) {
+    for(ullong l = 0; l < LOCK_W; ++l)
+        for(ullong i = 0; i < nsteps; ++i)
+            lock_step(g, l);
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*
+ *  AVX2 kernel on both halves of eight lanes one after the other, where the rare rejected draws
+ *  are redrawn by the scalar generator of their lane.
+ */
+__attribute__((target("avx2")))
+static inline __m256i lock_rotl8(__m256i x, int k) {
+    return _mm256_or_si256(_mm256_slli_epi32(x, k), _mm256_srli_epi32(x, 32-k));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i lock_next8(__m256i* s) {
+    __m256i r = _mm256_mullo_epi32(lock_rotl8(_mm256_mullo_epi32(s[1], _mm256_set1_epi32(5)), 7),
+                                   _mm256_set1_epi32(9));
+    __m256i t = _mm256_slli_epi32(s[1], 9);
+    s[2] = _mm256_xor_si256(s[2], s[0]);
+    s[3] = _mm256_xor_si256(s[3], s[1]);
+    s[1] = _mm256_xor_si256(s[1], s[2]);
+    s[0] = _mm256_xor_si256(s[0], s[3]);
+    s[2] = _mm256_xor_si256(s[2], t);
+    s[3] = lock_rotl8(s[3], 11);
+    return r;
+}
+
+/*
+ *  Returns the upper halves of r*n and writes a mask of the lanes to be redrawn to rej.
+ */
+__attribute__((target("avx2")))
+static inline __m256i lock_bound8(__m256i r, __m256i n, __m256i t, int* rej) {
+    __m256i even = _mm256_mul_epu32(r, n);
+    __m256i odd  = _mm256_mul_epu32(_mm256_srli_epi64(r, 32), n);
+    __m256i hi   = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    __m256i lo   = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    __m256i sign = _mm256_set1_epi32((int) 0x80000000);
+    *rej = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(
+                _mm256_xor_si256(t, sign), _mm256_xor_si256(lo, sign))));
+    return hi;
+}
+
+__attribute__((target("avx2")))
+static void lock_avx2(lgroup_t* g, ullong nsteps) {
+    ullong ns = g->nstates;
+    __m256i n1 = _mm256_set1_epi32(g->n),  t1 = _mm256_set1_epi32(g->t1);
+    __m256i n2 = _mm256_set1_epi32(g->n-1), t2 = _mm256_set1_epi32(g->t2);
+    __m256i one = _mm256_set1_epi32(1), mask = _mm256_set1_epi32(0xFFFF);
+    __m256i nsv = _mm256_set1_epi32(ns);
+    uint xs[8], ys[8];
+    int rej1, rej2;
+
+    for(ullong h = 0; h < LOCK_W; h += 8) {
+        __m256i s[4], active = _mm256_loadu_si256((__m256i*) (g->active+h));
+        for(int k = 0; k < 4; ++k)
+            s[k] = _mm256_loadu_si256((__m256i*) (g->s[k]+h));
+        uint* c = g->cnt + h;
+
+        for(ullong i = 0; i < nsteps; ++i) {
+            __m256i r1 = lock_next8(s), r2 = lock_next8(s);
+            __m256i x = lock_bound8(r1, n1, t1, &rej1);
+            __m256i y = lock_bound8(r2, n2, t2, &rej2);
+            if(rej1 | rej2) {
+                for(int k = 0; k < 4; ++k)
+                    _mm256_storeu_si256((__m256i*) (g->s[k]+h), s[k]);
+                _mm256_storeu_si256((__m256i*) xs, x);
+                _mm256_storeu_si256((__m256i*) ys, y);
+                for(int l = 0; l < 8; ++l) {
+                    if(rej1 & (1 << l))
+                        xs[l] = lock_bound(g, h+l, lock_next(g, h+l), g->n, g->t1);
+                    if(rej2 & (1 << l))
+                        ys[l] = lock_bound(g, h+l, lock_next(g, h+l), g->n-1, g->t2);
+                }
+                x = _mm256_loadu_si256((__m256i*) xs);
+                y = _mm256_loadu_si256((__m256i*) ys);
+                for(int k = 0; k < 4; ++k)
+                    s[k] = _mm256_loadu_si256((__m256i*) (g->s[k]+h));
+            }
+
+            // The counts stay below 2^31, thus the signed comparisons are exact
+            __m256i p = _mm256_set1_epi32(ns-1), q = p, acc = _mm256_setzero_si256(), sv;
+            for(ullong st = 0; st < ns-1; ++st) {
+                acc = _mm256_add_epi32(acc, _mm256_loadu_si256((__m256i*) (c + st*LOCK_W)));
+                p   = _mm256_add_epi32(p, _mm256_cmpgt_epi32(acc, x));
+            }
+            acc = _mm256_setzero_si256();
+            for(ullong st = 0; st < ns-1; ++st) {
+                sv  = _mm256_set1_epi32(st);
+                acc = _mm256_add_epi32(acc, _mm256_loadu_si256((__m256i*) (c + st*LOCK_W)));
+                // acc-[st >= p] equals acc-1+[p > st], where the comparison yields -1 for true
+                q   = _mm256_add_epi32(q, _mm256_cmpgt_epi32(
+                        _mm256_sub_epi32(_mm256_sub_epi32(acc, one), _mm256_cmpgt_epi32(p, sv)),
+                        y));
+            }
+
+            __m256i e  = _mm256_i32gather_epi32((int*) g->tab,
+                            _mm256_add_epi32(_mm256_mullo_epi32(p, nsv), q), 4);
+            __m256i p2 = _mm256_and_si256(e, mask), q2 = _mm256_srli_epi32(e, 16);
+            for(ullong st = 0; st < ns; ++st) {
+                sv = _mm256_set1_epi32(st);
+                __m256i d = _mm256_sub_epi32(
+                        _mm256_add_epi32(_mm256_cmpeq_epi32(p, sv), _mm256_cmpeq_epi32(q, sv)),
+                        _mm256_add_epi32(_mm256_cmpeq_epi32(p2, sv), _mm256_cmpeq_epi32(q2, sv)));
+                __m256i* cs = (__m256i*) (c + st*LOCK_W);
+                _mm256_storeu_si256(cs, _mm256_add_epi32(_mm256_loadu_si256(cs),
+                                                         _mm256_and_si256(d, active)));
             }
         }
 
-        if(l%2 == 0) {
-            p1 = linurn_draw(un);
-            linurn_insert(u, linurn_dist(un));
-            q1 = linurn_draw(u);
-        } else {
-            p1 = linurn_draw(u);
-            q1 = linurn_draw(un);
-            linurn_insert(u, linurn_dist(un));
+        for(int k = 0; k < 4; ++k)
+            _mm256_storeu_si256((__m256i*) (g->s[k]+h), s[k]);
+    }
+}
+
+/*
+ *  AVX-512 kernel on all sixteen lanes at once.
+ */
+__attribute__((target("avx512f")))
+static inline __m512i lock_next16(__m512i* s) {
+    __m512i r = _mm512_mullo_epi32(_mm512_rol_epi32(_mm512_mullo_epi32(s[1],
+                                   _mm512_set1_epi32(5)), 7), _mm512_set1_epi32(9));
+    __m512i t = _mm512_slli_epi32(s[1], 9);
+    s[2] = _mm512_xor_si512(s[2], s[0]);
+    s[3] = _mm512_xor_si512(s[3], s[1]);
+    s[1] = _mm512_xor_si512(s[1], s[2]);
+    s[0] = _mm512_xor_si512(s[0], s[3]);
+    s[2] = _mm512_xor_si512(s[2], t);
+    s[3] = _mm512_rol_epi32(s[3], 11);
+    return r;
+}
+
+__attribute__((target("avx512f")))
+static inline __m512i lock_bound16(__m512i r, __m512i n, __m512i t, __mmask16* rej) {
+    __m512i even = _mm512_mul_epu32(r, n);
+    __m512i odd  = _mm512_mul_epu32(_mm512_srli_epi64(r, 32), n);
+    __m512i hi   = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+    __m512i lo   = _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32));
+    *rej = _mm512_cmplt_epu32_mask(lo, t);
+    return hi;
+}
+
+__attribute__((target("avx512f")))
+static void lock_avx512(lgroup_t* g, ullong nsteps) {
+    ullong ns = g->nstates;
+    __m512i n1 = _mm512_set1_epi32(g->n),   t1 = _mm512_set1_epi32(g->t1);
+    __m512i n2 = _mm512_set1_epi32(g->n-1), t2 = _mm512_set1_epi32(g->t2);
+    __m512i one = _mm512_set1_epi32(1), mask = _mm512_set1_epi32(0xFFFF);
+    __m512i nsv = _mm512_set1_epi32(ns);
+    __mmask16 active = _mm512_cmpneq_epu32_mask(_mm512_loadu_si512(g->active),
+                                                _mm512_setzero_si512());
+    __m512i s[4];
+    for(int k = 0; k < 4; ++k)
+        s[k] = _mm512_loadu_si512(g->s[k]);
+    uint* c = g->cnt;
+    uint xs[LOCK_W], ys[LOCK_W];
+    __mmask16 rej1, rej2;
+
+    for(ullong i = 0; i < nsteps; ++i) {
+        __m512i r1 = lock_next16(s), r2 = lock_next16(s);
+        __m512i x = lock_bound16(r1, n1, t1, &rej1);
+        __m512i y = lock_bound16(r2, n2, t2, &rej2);
+        if(rej1 | rej2) {
+            for(int k = 0; k < 4; ++k)
+                _mm512_storeu_si512(g->s[k], s[k]);
+            _mm512_storeu_si512(xs, x);
+            _mm512_storeu_si512(ys, y);
+            for(int l = 0; l < LOCK_W; ++l) {
+                if(rej1 & (1 << l))
+                    xs[l] = lock_bound(g, l, lock_next(g, l), g->n, g->t1);
+                if(rej2 & (1 << l))
+                    ys[l] = lock_bound(g, l, lock_next(g, l), g->n-1, g->t2);
+            }
+            x = _mm512_loadu_si512(xs);
+            y = _mm512_loadu_si512(ys);
+            for(int k = 0; k < 4; ++k)
+                s[k] = _mm512_loadu_si512(g->s[k]);
         }
 
-        (*delta)(p1, q1, &p2, &q2); 
-        linurn_cinsert(u, p2, 1);
-        linurn_cinsert(u, q2, 1);
-        linurn_empty(un);
+        __m512i p = _mm512_setzero_si512(), q = p, acc = p, sv;
+        for(ullong st = 0; st < ns-1; ++st) {
+            acc = _mm512_add_epi32(acc, _mm512_loadu_si512(c + st*LOCK_W));
+            p   = _mm512_mask_add_epi32(p, _mm512_cmpge_epu32_mask(x, acc), p, one);
+        }
+        acc = _mm512_setzero_si512();
+        for(ullong st = 0; st < ns-1; ++st) {
+            sv  = _mm512_set1_epi32(st);
+            acc = _mm512_add_epi32(acc, _mm512_loadu_si512(c + st*LOCK_W));
+            __m512i a = _mm512_mask_sub_epi32(acc, _mm512_cmpge_epu32_mask(sv, p), acc, one);
+            q   = _mm512_mask_add_epi32(q, _mm512_cmpge_epu32_mask(y, a), q, one);
+        }
 
-        i += l/2+1;
-        while(j < nconf && i >= j*cstep)
-            memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+        __m512i e  = _mm512_i32gather_epi32(_mm512_add_epi32(_mm512_mullo_epi32(p, nsv), q),
+                                            g->tab, 4);
+        __m512i p2 = _mm512_and_si512(e, mask), q2 = _mm512_srli_epi32(e, 16);
+        for(ullong st = 0; st < ns; ++st) {
+            sv = _mm512_set1_epi32(st);
+            __m512i cs = _mm512_loadu_si512(c + st*LOCK_W);
+            cs = _mm512_mask_sub_epi32(cs, active & _mm512_cmpeq_epu32_mask(p, sv),  cs, one);
+            cs = _mm512_mask_sub_epi32(cs, active & _mm512_cmpeq_epu32_mask(q, sv),  cs, one);
+            cs = _mm512_mask_add_epi32(cs, active & _mm512_cmpeq_epu32_mask(p2, sv), cs, one);
+            cs = _mm512_mask_add_epi32(cs, active & _mm512_cmpeq_epu32_mask(q2, sv), cs, one);
+            _mm512_storeu_si512(c + st*LOCK_W, cs);
+        }
     }
-    while(j <= nconf)
-        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
 
-    linurn_destroy(un);
-    free(ic); free(rc);
-    return 1;
+    for(int k = 0; k < 4; ++k)
+        _mm512_storeu_si512(g->s[k], s[k]);
 }
+#endif
 
-int popsim_mbatch(bsturn_t* u, ullong nsteps, ullong nstates, ullong nconf, ullong* conf,
-                   void (*delta)(ullong, ullong, ullong*, ullong*),
-                   ullong seed1, ullong seed2, ullong seed3) {
-    bsturn_t* un = bsturn_create(seed1, nstates);
-    if(un == NULL) return 0;
+/*
+ *  Picks the widest kernel supported by the processor at runtime.
+ */
+static void (*lock_kernel(void))(lgroup_t*, ullong) {
+#if defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f"))
+        return lock_avx512;
+    if(__builtin_cpu_supports("avx2"))
+        return lock_avx2;
+#endif
+    return lock_scalar;
+}
 
-    ullong* ic = (ullong*) malloc(nstates * sizeof(ullong));
-    if(ic == NULL) return 0;
-    ullong* rc = (ullong*) malloc(nstates * sizeof(ullong));
-    if(rc == NULL) return 0;
+/*
+ *  Copies the counts of lane l into dist.
+ */
+static inline void lock_dist(lgroup_t* g, ullong l, ullong* dist) {
+    for(ullong s = 0; s < g->nstates; ++s)
+        dist[s] = g->cnt[s*LOCK_W+l];
+}
 
-    ullong p1, p2;
-    ullong q1, q2;
-    ullong r1, r2;
+int popsim_lockstep(linurn_t** u, ullong nreps, ullong nsteps, ullong nstates, snap_t* snap,
+                    ullong** conf, void (*delta)(ullong, ullong, ullong*, ullong*),
+                    popsim_stop_t* stop, ullong seed) {
+    ullong nconf = snap_nsnap(snap);
+    ullong n     = linurn_nmarbles(u[0]);
+    if(nstates > 0xFFFF || n < 2 || n >= (1LLU << 31)) {
+        errno = EDOM;
+        return 0;
+    }
+    for(ullong r = 1; r < nreps; ++r) {
+        if(linurn_nmarbles(u[r]) != n) {
+            errno = EDOM;
+            return 0;
+        }
+    }
 
-    ullong l;
-    coll_t c;
-    coll_seed(&c, seed2);
-    coll_setn(&c, bsturn_nmarbles(u));
+    lgroup_t g;
+    g.nstates = nstates;
+    g.n       = n;
+    g.t1      = (1LLU << 32) % n;
+    g.t2      = (1LLU << 32) % (n-1);
+    g.tab     = (uint*)   malloc(nstates*nstates * sizeof(uint));
+    g.cnt     = (uint*)   malloc(nstates*LOCK_W * sizeof(uint));
+    uint*   bcnt = (uint*)   malloc(nstates*LOCK_W * sizeof(uint));
+    ullong* dist = (ullong*) malloc(nstates * sizeof(ullong));
+    if(g.tab == NULL || g.cnt == NULL || bcnt == NULL || dist == NULL) {
+        free(g.tab); free(g.cnt); free(bcnt); free(dist);
+        return 0;
+    }
+
+    ullong p2, q2;
+    for(ullong p = 0; p < nstates; ++p) {
+        for(ullong q = 0; q < nstates; ++q) {
+            (*delta)(p, q, &p2, &q2);
+            g.tab[p*nstates+q] = p2 | (q2 << 16);
+        }
+    }
 
     mt_t mt;
-    mt_init(&mt, seed3);
+    mt_init(&mt, seed);
+    void (*kernel)(lgroup_t*, ullong) = lock_kernel();
+    uint bs[4][LOCK_W];
 
-    ullong epoch = (nstates*(ldouble) nstates) / (log(bsturn_nmarbles(u))/log(2.L));
-    epoch = POPSIM_MAX(epoch, 1);
-    int dir = 1;
-    timespec starttp, endtp;
-    ldouble pput = 0.L, cput = 0.L;
+    for(ullong r0 = 0; r0 < nreps; r0 += LOCK_W) {
+        // Lanes past the last replica copy the first one of the group and stay frozen
+        for(ullong l = 0; l < LOCK_W; ++l) {
+            linurn_t* ul = u[(r0+l < nreps) ? r0+l : r0];
+            for(ullong s = 0; s < nstates; ++s)
+                g.cnt[s*LOCK_W+l] = linurn_dist(ul)[s];
+            for(int k = 0; k < 4; ++k)
+                g.s[k][l] = mt_rand(&mt) | 1;
+            g.active[l] = (r0+l < nreps) ? 0xFFFFFFFF : 0;
+            if(r0+l < nreps) {
+                memcpy(conf[r0+l], linurn_dist(ul), nstates * sizeof(ullong));
+                if(stop != NULL && stop_init(stop+r0+l, linurn_dist(ul), nstates))
+                    g.active[l] = 0;
+            }
+        }
 
-    int fstcoll, scdcoll;
-    memcpy(conf, bsturn_dist(u), nstates * sizeof(ullong));
-    ullong cstep = nsteps / nconf;
-    ullong j = 1;
-    for(ullong i = 1, k = 0, t = 0; i <= nsteps; k = 0, t = 0) {
-        pput = cput;
-        clock_gettime(CLOCK_REALTIME, &starttp);
-
-        for(ullong e = 0; e < epoch && bsturn_nmarbles(u) > 0; ++e) {
-            coll_setr(&c, t + bsturn_nmarbles(un));
-            do {
-                l = coll_coll(&c); 
-            } while((t + bsturn_nmarbles(un) == 0) && l < 2);
-            t += 2*(l/2);
-
-            fstcoll = (l%2 == 0);
-            scdcoll = (fstcoll == 0) || mt_urand(&mt, bsturn_nmarbles(u)) < t;
-
-            if(fstcoll) {
-                if(mt_urand(&mt, t + bsturn_nmarbles(un)) < t) {
-                    p1 = bsturn_draw(u);
-                    r1 = bsturn_draw(u);
-                    (*delta)(p1, r1, &p2, &r2); k++;
-
-                    if(mt_real1(&mt) <= 0.5L) {
-                        bsturn_cinsert(un, r2, 1);
-                        p1 = p2;
-                    } else {
-                        bsturn_cinsert(un, p2, 1);
-                        p1 = r2;
-                    }
-                    t -= 2;
-                } else {
-                    p1 = bsturn_draw(un);
-                }
-            } else {
-                p1 = bsturn_draw(u);
+        ullong i = 0, j = 1, m, nact;
+        for(;;) {
+            nact = 0;
+            for(ullong l = 0; l < LOCK_W; ++l)
+                nact += (g.active[l] != 0);
+            if(i >= nsteps || nact == 0)
+                break;
+
+            // Blocks end at the next snapshot and are short enough for cheap replays
+            m = POPSIM_MIN(LOCK_CHECK, ((j < nconf) ? snap_step(snap, j) : nsteps) - i);
+            if(stop != NULL) {
+                memcpy(bcnt, g.cnt, nstates*LOCK_W * sizeof(uint));
+                memcpy(bs, g.s, sizeof(bs));
             }
+            (*kernel)(&g, m);
 
-            if(scdcoll) {
-                if(mt_urand(&mt, t + bsturn_nmarbles(un)) < t) {
-                    q1 = bsturn_draw(u);
-                    r1 = bsturn_draw(u);
-                    (*delta)(r1, q1, &r2, &q2); k++;
-
-                    if(mt_real1(&mt) <= 0.5L) {
-                        bsturn_cinsert(un, r2, 1);
-                        q1 = q2;
-                    } else {
-                        bsturn_cinsert(un, q2, 1);
-                        q1 = r2;
-                    }
-                    t -= 2;
-                } else {
-                    q1 = bsturn_draw(un);
+            // A lane whose condition holds after the block replays it to find the exact step
+            for(ullong l = 0; stop != NULL && l < LOCK_W; ++l) {
+                lock_dist(&g, l, dist);
+                if(g.active[l] == 0 || popsim_stopcond(stop+r0+l, dist, nstates) == 0)
+                    continue;
+
+                uint* cnt = g.cnt;
+                g.cnt = bcnt;
+                for(int k = 0; k < 4; ++k)
+                    g.s[k][l] = bs[k][l];
+                for(ullong k = 1; k <= m; ++k) {
+                    lock_step(&g, l);
+                    lock_dist(&g, l, dist);
+                    if(stop_check(stop+r0+l, dist, nstates, i+k))
+                        break;
                 }
-            } else {
-                q1 = bsturn_draw(u);
+                for(ullong s = 0; s < nstates; ++s)
+                    cnt[s*LOCK_W+l] = bcnt[s*LOCK_W+l];
+                g.cnt = cnt;
+                g.active[l] = 0;
             }
-            
-            (*delta)(p1, q1, &p2, &q2);
-            bsturn_cinsert(un, p2, 1);
-            bsturn_cinsert(un, q2, 1);
-            k++;
-        }
 
-        mhgeom(&mt, ic, bsturn_dist(u), nstates, bsturn_nmarbles(u), t/2);
-        bsturn_remove(u, ic);
-        for(p1 = 0; p1 < nstates; ++p1) {
-            mhgeom(&mt, rc, bsturn_dist(u), nstates, bsturn_nmarbles(u), ic[p1]);
-            bsturn_remove(u, rc);
-
-            for(q1 = 0; q1 < nstates; ++q1) {
-                (*delta)(p1, q1, &p2, &q2); 
-                bsturn_cinsert(un, p2, rc[q1]);
-                bsturn_cinsert(un, q2, rc[q1]);
+            i += m;
+            while(j < nconf && i == snap_step(snap, j)) {
+                for(ullong l = 0; l < LOCK_W && r0+l < nreps; ++l)
+                    lock_dist(&g, l, conf[r0+l] + j*nstates);
+                j++;
             }
         }
 
-        bsturn_insert(u, bsturn_dist(un));
-        k += t/2;
-        bsturn_empty(un);
-
-        clock_gettime(CLOCK_REALTIME, &endtp);
-        cput = k / ((endtp.tv_sec-starttp.tv_sec) + (endtp.tv_nsec-starttp.tv_nsec)*1e-9);
-        if(cput < pput)
-            dir *= -1;
-        epoch += dir;
-        epoch = POPSIM_MAX(epoch, 1);
-        
-        i += k;
-        while(j < nconf && i >= j*cstep)
-            memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+        for(ullong l = 0; l < LOCK_W && r0+l < nreps; ++l) {
+            lock_dist(&g, l, dist);
+            for(ullong k = j; k <= nconf; ++k)
+                memcpy(conf[r0+l] + k*nstates, dist, nstates * sizeof(ullong));
+            stop_end(stop != NULL ? stop+r0+l : NULL, nsteps);
+            linurn_empty(u[r0+l]);
+            linurn_insert(u[r0+l], dist);
+        }
     }
-    while(j <= nconf)
-        memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
 
-    bsturn_destroy(un);
-    free(ic); free(rc);
+    free(g.tab); free(g.cnt); free(bcnt); free(dist);
+    return 1;
+}
+
+/*
+ *  Number of ordered agent pairs of dist which the active transition t applies to.
+ */
+static inline ullong skip_weight(trans_t* t, ullong* dist) {
+    return dist[t->k[0]] * (dist[t->k[1]] - (t->k[0] == t->k[1]));
+}
+
+static inline void skip_reweigh(bsturn_t* w, trtab_t* tr, ullong* dist, ullong i) {
+    ullong nw = skip_weight(trtab_trans(tr, i), dist);
+    ullong ow = bsturn_cdist(w, i);
+    if(nw > ow)      bsturn_cinsert(w, i, nw-ow);
+    else if(nw < ow) bsturn_cremove(w, i, ow-nw);
+}
+
+/*
+ *  Updates the weights of all active transitions where s is either the initiator or responder.
+ */
+static void skip_update(bsturn_t* w, trtab_t* tr, ullong* dist, ullong s) {
+    ullong rfst = trtab_rbegin(tr, s) - trtab_trans(tr, 0);
+    ullong rend = trtab_rend  (tr, s) - trtab_trans(tr, 0);
+    for(ullong i = rfst; i < rend; ++i)
+        skip_reweigh(w, tr, dist, i);
+    for(ullong* i = trtab_cbegin(tr, s); i < trtab_cend(tr, s); ++i)
+        skip_reweigh(w, tr, dist, *i);
+}
+
+int popsim_seqskip(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   trtab_t* tr, popsim_stop_t* stop, ullong seed1, ullong seed2) {
+    ullong nconf = snap_nsnap(snap);
+    ullong* dist = linurn_dist(u);
+    ldouble npairs = linurn_nmarbles(u) * (ldouble) (linurn_nmarbles(u)-1);
+
+    // The urn w holds every active transition weighted by the number of pairs it applies to
+    bsturn_t* w = NULL;
+    if(trtab_ntrans(tr) > 0) {
+        if((w = bsturn_create(seed1, trtab_ntrans(tr))) == NULL)
+            return 0;
+        for(ullong i = 0; i < trtab_ntrans(tr); ++i)
+            bsturn_cinsert(w, i, skip_weight(trtab_trans(tr, i), dist));
+    }
+
+    mt_t mt;
+    mt_init(&mt, seed2);
+
+    memcpy(conf, dist, nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong g;
+    ldouble x;
+    trans_t* t;
+    ullong i = 0;
+    int stopped = stop_init(stop, dist, nstates);
+    for(; i < nsteps && !stopped && w != NULL && bsturn_nmarbles(w) > 0; ++i) {
+        // Number of null interactions before the next productive one is geometric
+        x = bsturn_nmarbles(w) / npairs;
+        if(x < 1.L) {
+            x = logl(mt_real3(&mt)) / log1pl(-x);
+            g = (x >= nsteps-i) ? nsteps-i : (ullong) x;
+        } else {
+            g = 0;
+        }
+
+        while(j < nconf && i+g >= snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+        if((i += g) >= nsteps) {
+            i = nsteps;
+            break;
+        }
+
+        t = trtab_trans(tr, bsturn_sample(w));
+        linurn_cremove(u, t->k[0], 1); linurn_cremove(u, t->k[1], 1);
+        linurn_cinsert(u, t->v[0], 1); linurn_cinsert(u, t->v[1], 1);
+        skip_update(w, tr, dist, t->k[0]); skip_update(w, tr, dist, t->k[1]);
+        skip_update(w, tr, dist, t->v[0]); skip_update(w, tr, dist, t->v[1]);
+        stopped = stop_check(stop, dist, nstates, i+1);
+
+        while(j < nconf && i+1 >= snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+    }
+    // A silent configuration never changes again
+    stop_end(stop, (w == NULL || bsturn_nmarbles(w) == 0) ? nsteps : i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+
+    if(w != NULL)
+        bsturn_destroy(w);
+    return 1;
+}
+
+/*
+ *  Worker of the batch phase. Each worker is responsible for the initiators in [lo,hi) and owns
+ *  its share rc of the responders, such that its pairs can be sampled independently of all other
+ *  workers. The occupied initiator states with active transitions are kept in the compact arrays
+ *  occ and cic, followed by a single row of all other initiators whose pairs are ignored.
+ */
+typedef struct pworker_t {
+    pthread_t thread;
+    mt_t      mt;
+
+    ullong   lo, hi;
+    ullong*  rc;
+    ullong*  occ;
+    ullong*  cic;
+    ullong*  work;
+    ullong*  out;
+    ullong   tp;
+    trans_t* t;
+
+    struct pbatch_t* b;
+} pworker_t;
+
+typedef struct pbatch_t {
+    ullong     nstates;
+    ullong*    ic;
+    trtab_t*   tr;
+    void     (*delta)(ullong, ullong, ullong*, ullong*);
+
+    popsim_noise_t* noise;
+    ullong*         cic;
+    ullong*         crc;
+    ullong*         flip;
+
+    ullong     nworkers;
+    ullong     nthreads;
+    pworker_t* w;
+
+    int               done;
+    pthread_mutex_t   lock;
+    pthread_barrier_t start, end;
+} pbatch_t;
+
+static inline int pbatch_active(pbatch_t* b, ullong p) {
+    return b->ic[p] > 0 && (b->tr == NULL || trtab_rbegin(b->tr, p) != trtab_rend(b->tr, p));
+}
+
+/*
+ *  Applies the x pairs of the i-th occupied initiator and the responder state q1, where the cells
+ *  of an initiator come in increasing order of the responders such that its transitions are
+ *  walked once.
+ */
+static void pworker_emit(ullong i, ullong q1, ullong x, void* arg) {
+    pworker_t* w = (pworker_t*) arg;
+    pbatch_t*  b = w->b;
+    ullong p1 = w->occ[i], p2, q2;
+    if(p1 == ULLONG_MAX)
+        return;
+
+    if(b->tr != NULL) {
+        trans_t* end = trtab_rend(b->tr, p1);
+        if(w->tp != p1) {
+            w->tp = p1;
+            w->t  = trtab_rbegin(b->tr, p1);
+        }
+        while(w->t < end && w->t->k[1] < q1)
+            ++w->t;
+        if(w->t < end && w->t->k[1] == q1) {
+            w->out[p1]         -= x; w->out[q1]         -= x;
+            w->out[w->t->v[0]] += x; w->out[w->t->v[1]] += x;
+        }
+    } else {
+        (*b->delta)(p1, q1, &p2, &q2);
+        w->out[p2] += x;
+        w->out[q2] += x;
+    }
+}
+
+static void pworker_rows(pworker_t* w) {
+    pbatch_t* b = w->b;
+    ullong nocc = 0, rest = 0;
+    for(ullong p = w->lo; p < w->hi; ++p) {
+        if(pbatch_active(b, p)) {
+            w->occ[nocc]   = p;
+            w->cic[nocc++] = b->ic[p];
+        } else {
+            rest += b->ic[p];
+        }
+    }
+
+    // With a transition table every agent keeps its state unless an active transition applies
+    if(b->tr != NULL) {
+        for(ullong p = w->lo; p < w->hi; ++p)
+            w->out[p] += b->ic[p];
+        for(ullong q = 0; q < b->nstates; ++q)
+            w->out[q] += w->rc[q];
+    }
+    if(nocc == 0)
+        return;
+
+    // Initiators without active transitions form the last row, they get whatever responders
+    // remain and keep their state anyway
+    w->occ[nocc] = ULLONG_MAX;
+    w->cic[nocc] = rest;
+    w->tp        = ULLONG_MAX;
+    mhgeom_pairs(&(w->mt), w->cic, nocc+1, w->rc, b->nstates, w->work, pworker_emit, w);
+}
+
+static void* pworker_run(void* data) {
+    pworker_t* w = (pworker_t*) data;
+
+    // The lock is held while the threads are created, after which done tells whether all of them
+    // and the barriers are ready
+    pthread_mutex_lock(&(w->b->lock));
+    int done = w->b->done;
+    pthread_mutex_unlock(&(w->b->lock));
+    if(done)
+        return NULL;
+
+    for(;;) {
+        pthread_barrier_wait(&(w->b->start));
+        if(w->b->done)
+            break;
+        pworker_rows(w);
+        pthread_barrier_wait(&(w->b->end));
+    }
+    return NULL;
+}
+
+/*
+ *  Stops the b->nthreads-1 running worker threads and frees all buffers of b.
+ */
+static void pbatch_destroy(pbatch_t* b) {
+    if(b->nthreads > 1) {
+        b->done = 1;
+        pthread_barrier_wait(&(b->start));
+        for(ullong i = 1; i < b->nthreads; ++i)
+            pthread_join(b->w[i].thread, NULL);
+        pthread_barrier_destroy(&(b->start));
+        pthread_barrier_destroy(&(b->end));
+        pthread_mutex_destroy(&(b->lock));
+    }
+    for(ullong i = 0; i < b->nworkers; ++i) {
+        free(b->w[i].rc);  free(b->w[i].occ); free(b->w[i].cic);
+        free(b->w[i].out); free(b->w[i].work);
+    }
+    free(b->w);
+    free(b->cic); free(b->crc); free(b->flip);
+}
+
+/*
+ *  Allocates nworkers workers of which all but the first get their own thread, where the
+ *  initiator counts are read from ic. Returns zero if there was not enough memory or the threads
+ *  could not be created, in which case everything allocated so far is freed again.
+ */
+static int pbatch_init(pbatch_t* b, ullong nworkers, ullong nstates, ullong* ic, trtab_t* tr,
+                       void (*delta)(ullong, ullong, ullong*, ullong*), mt_t* mt) {
+    b->nstates  = nstates;
+    b->ic       = ic;
+    b->tr       = tr;
+    b->delta    = delta;
+    b->nworkers = nworkers;
+    b->nthreads = 1;
+    b->done     = 0;
+    b->noise    = NULL;
+    b->cic      = NULL;
+    b->crc      = NULL;
+    b->flip     = NULL;
+
+    // The buffers start out as NULL such that a partial allocation can be freed
+    if((b->w = (pworker_t*) calloc(nworkers, sizeof(pworker_t))) == NULL)
+        return 0;
+    for(ullong i = 0; i < nworkers; ++i) {
+        b->w[i].b = b;
+        mt_init(&(b->w[i].mt), mt_rand(mt));
+        if((b->w[i].rc   = (ullong*) malloc(nstates * sizeof(ullong))) == NULL ||
+           (b->w[i].occ  = (ullong*) malloc((nstates+1) * sizeof(ullong))) == NULL ||
+           (b->w[i].cic  = (ullong*) malloc((nstates+1) * sizeof(ullong))) == NULL ||
+           (b->w[i].out  = (ullong*) calloc(nstates,  sizeof(ullong))) == NULL ||
+           (b->w[i].work = (ullong*) malloc(mhgeom_pairs_work(nstates+1, nstates) *
+                                             sizeof(ullong))) == NULL) {
+            pbatch_destroy(b);
+            errno = ENOMEM;
+            return 0;
+        }
+    }
+
+    if(nworkers > 1) {
+        if(pthread_mutex_init(&(b->lock), NULL) != 0) {
+            pbatch_destroy(b);
+            errno = EAGAIN;
+            return 0;
+        }
+
+        // The started workers wait on the lock until it is known whether all of them are running
+        pthread_mutex_lock(&(b->lock));
+        for(ullong i = 1; i < nworkers; ++i, ++b->nthreads)
+            if(pthread_create(&(b->w[i].thread), NULL, pworker_run, (void*) (b->w+i)) != 0)
+                break;
+
+        int ok = b->nthreads == nworkers;
+        if(ok && pthread_barrier_init(&(b->start), NULL, nworkers) != 0)
+            ok = 0;
+        if(ok && pthread_barrier_init(&(b->end), NULL, nworkers) != 0) {
+            pthread_barrier_destroy(&(b->start));
+            ok = 0;
+        }
+        b->done = !ok;
+        pthread_mutex_unlock(&(b->lock));
+
+        if(!ok) {
+            for(ullong i = 1; i < b->nthreads; ++i)
+                pthread_join(b->w[i].thread, NULL);
+            pthread_mutex_destroy(&(b->lock));
+            b->nthreads = 1;
+            pbatch_destroy(b);
+            errno = EAGAIN;
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ *  Splits the initiators into contiguous ranges holding roughly the same amount of occupied
+ *  states with active transitions and hands each worker an exact multivariate hypergeometric
+ *  share of the nresp responders in rc, which is consumed in the process. This is the first split
+ *  of the pair matrix, after which the blocks of the workers are independent.
+ */
+static void pbatch_split(pbatch_t* b, mt_t* mt, ullong* rc, ullong nresp) {
+    pworker_t* w = b->w;
+    ullong nocc = 0;
+    for(ullong p = 0; p < b->nstates; ++p)
+        nocc += pbatch_active(b, p);
+
+    ullong per = nocc/b->nworkers + (nocc%b->nworkers != 0);
+    ullong p = 0, m;
+    for(ullong i = 0; i < b->nworkers; ++i) {
+        w[i].lo = p;
+        m = 0;
+        for(ullong o = 0; p < b->nstates && (o < per || i == b->nworkers-1); ++p) {
+            o += pbatch_active(b, p);
+            m += b->ic[p];
+        }
+        w[i].hi = p;
+
+        if(i == b->nworkers-1) {
+            memcpy(w[i].rc, rc, b->nstates * sizeof(ullong));
+        } else if(m > 0) {
+            mhgeom(mt, w[i].rc, rc, b->nstates, nresp, m);
+            for(ullong q = 0; q < b->nstates; ++q)
+                rc[q] -= w[i].rc[q];
+        } else {
+            memset(w[i].rc, 0, b->nstates * sizeof(ullong));
+        }
+        nresp -= m;
+    }
+}
+
+/*
+ *  Lets every batch of b be corrupted by the noise model noise. Returns zero if there was not
+ *  enough memory.
+ */
+static int pbatch_noise(pbatch_t* b, popsim_noise_t* noise) {
+    b->noise = noise;
+    if(noise == NULL)
+        return 1;
+
+    b->cic  = (ullong*) malloc(b->nstates * sizeof(ullong));
+    b->crc  = (ullong*) malloc(b->nstates * sizeof(ullong));
+    b->flip = (ullong*) malloc(b->nstates * sizeof(ullong));
+    return b->cic != NULL && b->crc != NULL && b->flip != NULL;
+}
+
+/*
+ *  Pairs the initiators in ic with the nresp responders in rc uniformly at random and returns the
+ *  states of all agents after their interactions. The returned array is valid until the next run.
+ */
+static ullong* pbatch_run(pbatch_t* b, mt_t* mt, ullong* rc, ullong nresp) {
+    for(ullong i = 0; i < b->nworkers; ++i)
+        memset(b->w[i].out, 0, b->nstates * sizeof(ullong));
+
+    // The corrupted interactions are a uniform subset of the pairs, thus their initiators and
+    // responders are uniform subsets of either side and they are removed before the pairing
+    ullong x = 0;
+    if(b->noise != NULL && (x = binom(mt, nresp, b->noise->eps)) > 0) {
+        mhgeom(mt, b->cic, b->ic, b->nstates, nresp, x);
+        mhgeom(mt, b->crc, rc,    b->nstates, nresp, x);
+        mbinom(mt, b->flip, b->noise->target, b->nstates, x);
+        for(ullong q = 0; q < b->nstates; ++q) {
+            b->ic[q] -= b->cic[q];
+            rc[q]    -= b->crc[q];
+        }
+        nresp -= x;
+    }
+
+    pbatch_split(b, mt, rc, nresp);
+    if(b->nworkers > 1)
+        pthread_barrier_wait(&(b->start));
+    pworker_rows(b->w);
+    if(b->nworkers > 1)
+        pthread_barrier_wait(&(b->end));
+
+    for(ullong i = 1; i < b->nworkers; ++i)
+        for(ullong q = 0; q < b->nstates; ++q)
+            b->w[0].out[q] += b->w[i].out[q];
+    if(x > 0)
+        for(ullong q = 0; q < b->nstates; ++q)
+            b->w[0].out[q] += b->crc[q] + b->flip[q];
+
+    return b->w[0].out;
+}
+
+/*
+ *  Applies delta to (p1,q1) unless the noise model corrupts the interaction, in which case the
+ *  initiator flips to a target state and the responder keeps its state.
+ */
+static inline void noise_delta(popsim_noise_t* noise, mt_t* mt, ullong nstates,
+                               void (*delta)(ullong, ullong, ullong*, ullong*),
+                               ullong p1, ullong q1, ullong* p2, ullong* q2) {
+    if(noise == NULL || mt_real2(mt) >= noise->eps) {
+        (*delta)(p1, q1, p2, q2);
+        return;
+    }
+
+    *q2 = q1;
+    if(noise->target == NULL) {
+        *p2 = mt_urand(mt, nstates);
+        return;
+    }
+    ldouble x = mt_real2(mt);
+    for(*p2 = 0; *p2 < nstates-1 && x >= noise->target[*p2]; ++*p2)
+        x -= noise->target[*p2];
+}
+
+/*
+ *  Initial epoch, which balances the cost of a batch phase with nstates^2 pairs of states against
+ *  the cost of the collisions.
+ */
+static ullong epoch_initial(ullong nstates, ullong nagents) {
+    ullong epoch = (nstates*(ldouble) nstates) / (log(nagents)/log(2.L));
+    return POPSIM_MAX(epoch, 1);
+}
+
+static void epoch_timed_begin(popsim_epoch_t* p) {
+    clock_gettime(CLOCK_MONOTONIC, &p->start);
+}
+
+static void epoch_timed_end(popsim_epoch_t* p, ullong ncoll, ullong nint, ullong lastl) {
+    (void) ncoll; (void) lastl;
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    ldouble cput = nint / ((end.tv_sec-p->start.tv_sec) + (end.tv_nsec-p->start.tv_nsec)*1e-9L);
+    if(cput < p->pput)
+        p->dir *= -1;
+    p->pput = cput;
+    p->epoch = (p->dir < 0 && p->epoch == 1) ? 1 : p->epoch + p->dir;
+}
+
+void popsim_epoch_timed(popsim_epoch_t* p, ullong nstates, ullong nagents) {
+    p->begin = &epoch_timed_begin;
+    p->end   = &epoch_timed_end;
+    p->epoch = epoch_initial(nstates, nagents);
+    p->dir   = 1;
+    p->pput  = 0.L;
+}
+
+static void epoch_model_begin(popsim_epoch_t* p) {
+    (void) p;
+}
+
+/*
+ *  A collision costs about one draw from the bst urn per agent and the batch phase about one
+ *  hypergeometric sample per pair of states. One more collision per epoch pays off as long as the
+ *  interactions it adds, i.e. the collision-free ones before it and itself, are cheaper than the
+ *  average of the epoch.
+ */
+static void epoch_model_end(popsim_epoch_t* p, ullong ncoll, ullong nint, ullong lastl) {
+    // Truncated epochs say nothing about the throughput of a full epoch
+    if(ncoll < p->epoch)
+        return;
+
+    ldouble cost = ncoll * p->ccost + p->bcost;
+    ldouble marg = (lastl/2 + 1) / p->ccost;
+    ullong  step = POPSIM_MAX(p->epoch/8, 1);
+    if(marg * cost > nint)
+        p->epoch += step;
+    else
+        p->epoch = (p->epoch > step) ? p->epoch - step : 1;
+}
+
+void popsim_epoch_model(popsim_epoch_t* p, ullong nstates, ullong nagents) {
+    p->begin = &epoch_model_begin;
+    p->end   = &epoch_model_end;
+    p->epoch = epoch_initial(nstates, nagents);
+    p->ccost = 2.L * (log2l(nstates) + 1.L);
+    p->bcost = nstates * (ldouble) nstates;
+}
+
+int popsim_batch(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                 void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                 popsim_stop_t* stop, popsim_noise_t* noise,
+                 ullong seed1, ullong seed2, ullong seed3) {
+    ullong nconf = snap_nsnap(snap);
+    linurn_t* un = linurn_create(seed1, nstates);
+    if(un == NULL) return 0;
+
+    ullong* ic = (ullong*) malloc(nstates * sizeof(ullong));
+    if(ic == NULL) return 0;
+    ullong* rc = (ullong*) malloc(nstates * sizeof(ullong));
+    if(rc == NULL) return 0;
+
+    ullong p1, p2;
+    ullong q1, q2;
+    
+    ullong l;
+    coll_t c;
+    coll_seed(&c, seed2);
+    coll_setnr(&c, linurn_nmarbles(u), 0);
+
+    mt_t mt;
+    mt_init(&mt, seed3);
+
+    pbatch_t b;
+    if(pbatch_init(&b, 1, nstates, ic, tr, delta, &mt) == 0 || pbatch_noise(&b, noise) == 0)
+        return 0;
+
+    memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong i = 0, m;
+    int stopped = stop_init(stop, linurn_dist(u), nstates);
+    while(i < nsteps && !stopped) {
+        do {
+            l = coll_coll(&c); 
+        } while(l < 2);
+
+        // If the next snapshot is reached before the collision, then the interactions up to it
+        // are collision free and the batch is truncated there
+        m = ((j < nconf) ? snap_step(snap, j) : nsteps) - i;
+        if(l/2 >= m) {
+            mhgeom(&mt, ic, linurn_dist(u), nstates, linurn_nmarbles(u), m);
+            linurn_remove(u, ic);
+            mhgeom(&mt, rc, linurn_dist(u), nstates, linurn_nmarbles(u), m);
+            linurn_remove(u, rc);
+            linurn_insert(u, pbatch_run(&b, &mt, rc, m));
+            i += m;
+            while(j < nconf && i == snap_step(snap, j))
+                memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+            stopped = stop_check(stop, linurn_dist(u), nstates, i);
+            continue;
+        }
+
+        mhgeom(&mt, ic, linurn_dist(u), nstates, linurn_nmarbles(u), l/2);
+        linurn_remove(u, ic);
+        mhgeom(&mt, rc, linurn_dist(u), nstates, linurn_nmarbles(u), l/2);
+        linurn_remove(u, rc);
+        linurn_insert(un, pbatch_run(&b, &mt, rc, l/2));
+
+        if(l%2 == 0) {
+            p1 = linurn_draw(un);
+            linurn_insert(u, linurn_dist(un));
+            q1 = linurn_draw(u);
+        } else {
+            p1 = linurn_draw(u);
+            q1 = linurn_draw(un);
+            linurn_insert(u, linurn_dist(un));
+        }
+
+        noise_delta(noise, &mt, nstates, delta, p1, q1, &p2, &q2);
+        linurn_cinsert(u, p2, 1);
+        linurn_cinsert(u, q2, 1);
+        linurn_empty(un);
+
+        i += l/2+1;
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+        stopped = stop_check(stop, linurn_dist(u), nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+
+    pbatch_destroy(&b);
+    linurn_destroy(un);
+    free(ic); free(rc);
+    return 1;
+}
+
+int popsim_crn(linurn_t** u, ullong nsteps, ullong nstates, snap_t* snap, ullong** conf,
+               void (**delta)(ullong, ullong, ullong*, ullong*), trtab_t** tr,
+               popsim_stop_t* stop, ullong seed1, ullong seed2, ullong seed3) {
+    if(linurn_nmarbles(u[0]) != linurn_nmarbles(u[1])) {
+        errno = EDOM;
+        return 0;
+    }
+
+    ullong nconf = snap_nsnap(snap);
+    linurn_t* un[2];
+    ullong*   ic[2];
+    ullong*   rc[2];
+    mt_t      mt[2];
+    pbatch_t  b[2];
+
+    // Both lanes start from the same seeds, thus their collision steps draw the same uniforms
+    mt_t rng, rs[2];
+    mt_init(&rng, seed3);
+    for(ullong a = 0; a < 2; ++a) {
+        linurn_seed(u[a], seed1);
+        if((un[a] = linurn_create(seed2, nstates)) == NULL) return 0;
+        if((ic[a] = (ullong*) malloc(nstates * sizeof(ullong))) == NULL) return 0;
+        if((rc[a] = (ullong*) malloc(nstates * sizeof(ullong))) == NULL) return 0;
+        mt_init(mt+a, seed3);
+        if(pbatch_init(b+a, 1, nstates, ic[a], tr[a], delta[a], mt+a) == 0) return 0;
+    }
+
+    ullong p1, p2;
+    ullong q1, q2;
+
+    ullong l;
+    coll_t c;
+    coll_seed(&c, seed2);
+    coll_setnr(&c, linurn_nmarbles(u[0]), 0);
+
+    // The snapshot steps are shared, where j[a] is the next snapshot of lane a left to be filled
+    int stopped[2];
+    ullong j[2] = {1, 1};
+    ullong jn = 1;
+    ullong i = 0, m;
+    for(ullong a = 0; a < 2; ++a) {
+        memcpy(conf[a], linurn_dist(u[a]), nstates * sizeof(ullong));
+        stopped[a] = stop_init(stop != NULL ? stop+a : NULL, linurn_dist(u[a]), nstates);
+    }
+    while(i < nsteps && !(stopped[0] && stopped[1])) {
+        // The lanes share the batch lengths since they only depend on the number of agents
+        do {
+            l = coll_coll(&c);
+        } while(l < 2);
+        // As in popsim_batch, a snapshot reached before the collision truncates the batch there
+        m = ((jn < nconf) ? snap_step(snap, jn) : nsteps) - i;
+        int trunc = (l/2 >= m);
+        if(!trunc)
+            m = l/2;
+
+        // The hypergeometric samplers consume a varying number of uniforms depending on the
+        // configuration, thus both lanes restart from the same generator states in every round
+        mt_init(rs, mt_rand(&rng));
+        mt_init(rs+1, mt_rand(&rng));
+        for(ullong a = 0; a < 2; ++a) {
+            if(stopped[a])
+                continue;
+            memcpy(mt+a, rs, sizeof(mt_t));
+            memcpy(&(b[a].w[0].mt), rs+1, sizeof(mt_t));
+
+            mhgeom(mt+a, ic[a], linurn_dist(u[a]), nstates, linurn_nmarbles(u[a]), m);
+            linurn_remove(u[a], ic[a]);
+            mhgeom(mt+a, rc[a], linurn_dist(u[a]), nstates, linurn_nmarbles(u[a]), m);
+            linurn_remove(u[a], rc[a]);
+            if(trunc) {
+                linurn_insert(u[a], pbatch_run(b+a, mt+a, rc[a], m));
+            } else {
+                linurn_insert(un[a], pbatch_run(b+a, mt+a, rc[a], m));
+                if(l%2 == 0) {
+                    p1 = linurn_draw(un[a]);
+                    linurn_insert(u[a], linurn_dist(un[a]));
+                    q1 = linurn_draw(u[a]);
+                } else {
+                    p1 = linurn_draw(u[a]);
+                    q1 = linurn_draw(un[a]);
+                    linurn_insert(u[a], linurn_dist(un[a]));
+                }
+                delta[a](p1, q1, &p2, &q2);
+                linurn_cinsert(u[a], p2, 1);
+                linurn_cinsert(u[a], q2, 1);
+                linurn_empty(un[a]);
+            }
+        }
+
+        i += trunc ? m : m+1;
+        for(; jn < nconf && i == snap_step(snap, jn); ++jn)
+            for(ullong a = 0; a < 2; ++a)
+                if(!stopped[a])
+                    memcpy(conf[a] + jn*nstates, linurn_dist(u[a]), nstates * sizeof(ullong));
+        for(ullong a = 0; a < 2; ++a) {
+            if(stopped[a])
+                continue;
+            j[a] = jn;
+            stopped[a] = stop_check(stop != NULL ? stop+a : NULL, linurn_dist(u[a]), nstates, i);
+        }
+    }
+
+    for(ullong a = 0; a < 2; ++a) {
+        if(stop != NULL)
+            stop_end(stop+a, i);
+        while(j[a] <= nconf)
+            memcpy(conf[a] + (j[a]++)*nstates, linurn_dist(u[a]), nstates * sizeof(ullong));
+        pbatch_destroy(b+a);
+        linurn_destroy(un[a]);
+        free(ic[a]); free(rc[a]);
+    }
+    return 1;
+}
+
+int popsim_mbatch(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                   popsim_stop_t* stop, popsim_noise_t* noise, popsim_epoch_t* ep,
+                   ullong seed1, ullong seed2, ullong seed3) {
+    return popsim_pmbatch(u, nsteps, nstates, snap, conf, delta, tr, stop, noise, ep, 1,
+                          seed1, seed2, seed3);
+}
+
+/*
+ *  State of the multi batched simulation of the urn u between epochs, such that the epochs can be
+ *  run one by one and interleaved with sequential steps on u.
+ */
+typedef struct mbatch_t {
+    bsturn_t* u;
+    bsturn_t* un;
+    ullong    nstates;
+    ullong*   ic;
+    ullong*   rc;
+    void    (*delta)(ullong, ullong, ullong*, ullong*);
+    popsim_noise_t* noise;
+
+    coll_t   c;
+    mt_t     mt;
+    pbatch_t b;
+
+    popsim_epoch_t* ep;
+    popsim_epoch_t  dep;
+    ullong          lastl;
+} mbatch_t;
+
+static int mbatch_init(mbatch_t* s, bsturn_t* u, ullong nstates,
+                       void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                       popsim_noise_t* noise, popsim_epoch_t* ep, ullong nworkers,
+                       ullong seed1, ullong seed2, ullong seed3) {
+    s->u       = u;
+    s->nstates = nstates;
+    s->delta   = delta;
+    s->lastl   = 0;
+
+    if((s->un = bsturn_create(seed1, nstates)) == NULL)
+        return 0;
+    if((s->ic = (ullong*) malloc(nstates * sizeof(ullong))) == NULL)
+        return 0;
+    if((s->rc = (ullong*) malloc(nstates * sizeof(ullong))) == NULL)
+        return 0;
+
+    coll_seed(&s->c, seed2);
+    coll_setn(&s->c, bsturn_nmarbles(u));
+    mt_init(&s->mt, seed3);
+
+    s->noise = noise;
+    if(pbatch_init(&s->b, nworkers, nstates, s->ic, tr, delta, &s->mt) == 0 ||
+            pbatch_noise(&s->b, noise) == 0)
+        return 0;
+
+    if(ep == NULL) {
+        popsim_epoch_timed(&s->dep, nstates, bsturn_nmarbles(u));
+        ep = &s->dep;
+    }
+    s->ep = ep;
+    return 1;
+}
+
+/*
+ *  Runs a single epoch of at most m interactions and returns the number of interactions done. The
+ *  epoch ends exactly after m interactions if the collisions would cross it.
+ */
+static ullong mbatch_epoch(mbatch_t* s, ullong m) {
+    bsturn_t* u  = s->u;
+    bsturn_t* un = s->un;
+    mt_t*     mt = &s->mt;
+    void (*delta)(ullong, ullong, ullong*, ullong*) = s->delta;
+
+    ullong p1, p2;
+    ullong q1, q2;
+    ullong r1, r2;
+    ullong l, e;
+    ullong k = 0, t = 0;
+    int fstcoll, scdcoll;
+
+    (*s->ep->begin)(s->ep);
+
+    // k+t/2 interactions are done so far
+    for(e = 0; e < s->ep->epoch && bsturn_nmarbles(u) > 0 && k + t/2 < m; ++e) {
+        coll_setr(&s->c, t + bsturn_nmarbles(un));
+        do {
+            l = coll_coll(&s->c); 
+        } while((t + bsturn_nmarbles(un) == 0) && l < 2);
+
+        if(k + t/2 + l/2 >= m) {
+            t += 2*(m - k - t/2);
+            break;
+        }
+        t += 2*(l/2);
+        s->lastl = l;
+
+        fstcoll = (l%2 == 0);
+        scdcoll = (fstcoll == 0) || mt_urand(mt, bsturn_nmarbles(u)) < t;
+
+        if(fstcoll) {
+            if(mt_urand(mt, t + bsturn_nmarbles(un)) < t) {
+                p1 = bsturn_draw(u);
+                r1 = bsturn_draw(u);
+                noise_delta(s->noise, mt, s->nstates, delta, p1, r1, &p2, &r2); k++;
+
+                if(mt_real1(mt) <= 0.5L) {
+                    bsturn_cinsert(un, r2, 1);
+                    p1 = p2;
+                } else {
+                    bsturn_cinsert(un, p2, 1);
+                    p1 = r2;
+                }
+                t -= 2;
+            } else {
+                p1 = bsturn_draw(un);
+            }
+        } else {
+            p1 = bsturn_draw(u);
+        }
+
+        if(scdcoll) {
+            if(mt_urand(mt, t + bsturn_nmarbles(un)) < t) {
+                q1 = bsturn_draw(u);
+                r1 = bsturn_draw(u);
+                noise_delta(s->noise, mt, s->nstates, delta, r1, q1, &r2, &q2); k++;
+
+                if(mt_real1(mt) <= 0.5L) {
+                    bsturn_cinsert(un, r2, 1);
+                    q1 = q2;
+                } else {
+                    bsturn_cinsert(un, q2, 1);
+                    q1 = r2;
+                }
+                t -= 2;
+            } else {
+                q1 = bsturn_draw(un);
+            }
+        } else {
+            q1 = bsturn_draw(u);
+        }
+        
+        noise_delta(s->noise, mt, s->nstates, delta, p1, q1, &p2, &q2);
+        bsturn_cinsert(un, p2, 1);
+        bsturn_cinsert(un, q2, 1);
+        k++;
+    }
+
+    // Batch phase: the t/2 pending interactions are resolved by first sampling all
+    // initiators and responders and then splitting the responders among the initiators
+    if(t > 0) {
+        mhgeom(mt, s->ic, bsturn_dist(u), s->nstates, bsturn_nmarbles(u), t/2);
+        bsturn_remove(u, s->ic);
+        mhgeom(mt, s->rc, bsturn_dist(u), s->nstates, bsturn_nmarbles(u), t/2);
+        bsturn_remove(u, s->rc);
+        bsturn_insert(u, pbatch_run(&s->b, mt, s->rc, t/2));
+    }
+
+    bsturn_insert(u, bsturn_dist(un));
+    k += t/2;
+    bsturn_empty(un);
+
+    (*s->ep->end)(s->ep, e, k, s->lastl);
+    return k;
+}
+
+static void mbatch_destroy(mbatch_t* s) {
+    pbatch_destroy(&s->b);
+    bsturn_destroy(s->un);
+    free(s->ic); free(s->rc);
+}
+
+int popsim_pmbatch(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                   void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                   popsim_stop_t* stop, popsim_noise_t* noise, popsim_epoch_t* ep,
+                   ullong nworkers, ullong seed1, ullong seed2, ullong seed3) {
+    ullong nconf = snap_nsnap(snap);
+    mbatch_t s;
+    if(mbatch_init(&s, u, nstates, delta, tr, noise, ep, nworkers, seed1, seed2, seed3) == 0)
+        return 0;
+
+    memcpy(conf, bsturn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong i = 0;
+    int stopped = stop_init(stop, bsturn_dist(u), nstates);
+    while(i < nsteps && !stopped) {
+        i += mbatch_epoch(&s, ((j < nconf) ? snap_step(snap, j) : nsteps) - i);
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+        stopped = stop_check(stop, bsturn_dist(u), nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+
+    mbatch_destroy(&s);
+    return 1;
+}
+
+/*
+ *  Seconds elapsed since start on the monotonic clock.
+ */
+static ldouble hybrid_elapsed(timespec* start) {
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec-start->tv_sec) + (end.tv_nsec-start->tv_nsec)*1e-9L;
+}
+
+int popsim_hybrid(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                  popsim_stop_t* stop, popsim_epoch_t* ep,
+                  ullong seed1, ullong seed2, ullong seed3) {
+    ullong nconf = snap_nsnap(snap);
+    mbatch_t s;
+    if(mbatch_init(&s, u, nstates, delta, tr, NULL, ep, 1, seed1, seed2, seed3) == 0)
+        return 0;
+
+    // Estimated seconds per interaction of either engine, where unmeasured ones are zero such that
+    // both are tried first
+    ldouble cost[2] = {0.L, 0.L};
+    ullong  chunk   = HYBRID_MINCHUNK;
+    ullong  round   = 0;
+    int     engine, best = 0;
+    ldouble secs;
+    timespec start;
+
+    ullong p1, q1, p2, q2;
+    ullong k, m;
+    memcpy(conf, bsturn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong i = 0;
+    int stopped = stop_init(stop, bsturn_dist(u), nstates);
+    while(i < nsteps && !stopped) {
+        // The engine which is currently slower is revisited from time to time as the costs
+        // change with the configuration
+        engine = (++round % HYBRID_PROBE == 0) ? !best : best;
+        m = ((j < nconf) ? snap_step(snap, j) : nsteps) - i;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if(engine == HYBRID_SEQ) {
+            m = POPSIM_MIN(m, chunk);
+            for(k = 0; k < m && !stopped;) {
+                p1 = bsturn_draw(u); q1 = bsturn_draw(u); 
+                (*delta)(p1, q1, &p2, &q2); 
+                bsturn_cinsert(u, p2, 1); bsturn_cinsert(u, q2, 1);
+                ++k;
+
+                if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2))
+                    stopped = stop_check(stop, bsturn_dist(u), nstates, i+k);
+            }
+        } else {
+            k = mbatch_epoch(&s, m);
+        }
+        secs = hybrid_elapsed(&start);
+        cost[engine] = (cost[engine] == 0.L) ? secs / k : (3.L*cost[engine] + secs / k) / 4.L;
+
+        // Sequential rounds should take about as long as an epoch, such that retrying the
+        // sequential engine is as expensive as retrying the batched one
+        if(engine == HYBRID_BATCH && cost[HYBRID_SEQ] > 0.L)
+            chunk = POPSIM_MAX(secs / cost[HYBRID_SEQ], HYBRID_MINCHUNK);
+        best = (cost[HYBRID_SEQ] == 0.L || cost[HYBRID_BATCH] == 0.L)
+             ? (cost[HYBRID_SEQ] == 0.L ? HYBRID_SEQ : HYBRID_BATCH)
+             : (cost[HYBRID_BATCH] < cost[HYBRID_SEQ]);
+
+        i += k;
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+        if(engine == HYBRID_BATCH)
+            stopped = stop_check(stop, bsturn_dist(u), nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+
+    mbatch_destroy(&s);
+    return 1;
+}
+
+/*
+ *  Adds the interaction (p1,q1)->(p2,q2) of probability prob to the drift mu and the second moment
+ *  var of the change of every state count per interaction.
+ */
+static inline void leap_add(ldouble* mu, ldouble* var, ullong p1, ullong q1, ullong p2, ullong q2,
+                            ldouble prob) {
+    ullong s[4] = {p1, q1, p2, q2};
+    for(int k = 0; k < 4; ++k) {
+        int seen = 0;
+        for(int l = 0; l < k; ++l)
+            seen |= (s[l] == s[k]);
+        if(seen)
+            continue;
+
+        ldouble net = (p2 == s[k]) + (q2 == s[k]) - (ldouble) ((p1 == s[k]) + (q1 == s[k]));
+        mu[s[k]]  += prob * net;
+        var[s[k]] += prob * net * net;
+    }
+}
+
+/*
+ *  Largest number of interactions such that the expected change and the standard deviation of
+ *  every state count stay below eps times the count or a single agent, which is the leap condition
+ *  of Y. Cao, D. T. Gillespie, and L. R. Petzold. Efficient step size selection for the
+ *  tau-leaping simulation method. 2006. Returns infinity if the configuration is silent.
+ */
+static ldouble leap_size(ullong* dist, ullong nstates, ullong n, ldouble eps,
+                         void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                         ldouble* mu, ldouble* var) {
+    for(ullong q = 0; q < nstates; ++q)
+        mu[q] = var[q] = 0.L;
+
+    ldouble pairs = n * (ldouble) (n-1);
+    if(tr != NULL) {
+        for(ullong k = 0; k < trtab_ntrans(tr); ++k) {
+            trans_t* t = trtab_trans(tr, k);
+            if(dist[t->k[0]] > 0 && dist[t->k[1]] > (t->k[0] == t->k[1]))
+                leap_add(mu, var, t->k[0], t->k[1], t->v[0], t->v[1],
+                         dist[t->k[0]] * (ldouble) (dist[t->k[1]] - (t->k[0] == t->k[1])) / pairs);
+        }
+    } else {
+        ullong p2, q2;
+        for(ullong p1 = 0; p1 < nstates; ++p1) {
+            if(dist[p1] == 0)
+                continue;
+            for(ullong q1 = 0; q1 < nstates; ++q1) {
+                if(dist[q1] <= (p1 == q1))
+                    continue;
+                (*delta)(p1, q1, &p2, &q2);
+                if(POPSIM_CHANGED(p1, q1, p2, q2))
+                    leap_add(mu, var, p1, q1, p2, q2,
+                             dist[p1] * (ldouble) (dist[q1] - (p1 == q1)) / pairs);
+            }
+        }
+    }
+
+    ldouble l = INFINITY, bound;
+    for(ullong q = 0; q < nstates; ++q) {
+        bound = POPSIM_MAX(eps * dist[q], 1.L);
+        if(mu[q] != 0.L)
+            l = POPSIM_MIN(l, bound / fabsl(mu[q]));
+        if(var[q] > 0.L)
+            l = POPSIM_MIN(l, bound * bound / var[q]);
+    }
+    return l;
+}
+
+int popsim_leap(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                popsim_stop_t* stop, ldouble eps, ullong seed1) {
+    ullong nconf = snap_nsnap(snap);
+    ullong*  ic  = (ullong*)  malloc(nstates * sizeof(ullong));
+    ullong*  rc  = (ullong*)  malloc(nstates * sizeof(ullong));
+    ldouble* mu  = (ldouble*) malloc(nstates * sizeof(ldouble));
+    ldouble* var = (ldouble*) malloc(nstates * sizeof(ldouble));
+    if(ic == NULL || rc == NULL || mu == NULL || var == NULL) {
+        free(ic); free(rc); free(mu); free(var);
+        return 0;
+    }
+
+    mt_t mt;
+    mt_init(&mt, seed1);
+
+    pbatch_t b;
+    if(pbatch_init(&b, 1, nstates, ic, tr, delta, &mt) == 0)
+        return 0;
+
+    ullong p1, p2;
+    ullong q1, q2;
+    ullong n = linurn_nmarbles(u);
+    ldouble l;
+
+    memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong i = 0, k, m;
+    int stopped = stop_init(stop, linurn_dist(u), nstates);
+    while(i < nsteps && !stopped) {
+        m = ((j < nconf) ? snap_step(snap, j) : nsteps) - i;
+        l = leap_size(linurn_dist(u), nstates, n, eps, delta, tr, mu, var);
+
+        if(isinf(l)) {
+            // Silent configurations keep their counts up to the next snapshot
+            k = m;
+        } else if(l < LEAP_MINLEAP) {
+            k = POPSIM_MIN(m, LEAP_MINLEAP);
+            for(ullong h = 0; h < k; ++h) {
+                p1 = linurn_draw(u);
+                q1 = linurn_draw(u);
+                (*delta)(p1, q1, &p2, &q2);
+                linurn_cinsert(u, p2, 1);
+                linurn_cinsert(u, q2, 1);
+            }
+        } else {
+            // A leap is a single batch phase of disjoint pairs, thus at most half of the agents
+            // interact and the collisions within the leap are neglected. The bound is clamped
+            // before the cast, since it can exceed the range of ullong close to silence
+            k = POPSIM_MIN(m, n/2);
+            if(l < (ldouble) k)
+                k = (ullong) l;
+            mhgeom(&mt, ic, linurn_dist(u), nstates, n, k);
+            linurn_remove(u, ic);
+            mhgeom(&mt, rc, linurn_dist(u), nstates, n - k, k);
+            linurn_remove(u, rc);
+            linurn_insert(u, pbatch_run(&b, &mt, rc, k));
+        }
+
+        i += k;
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+        stopped = stop_check(stop, linurn_dist(u), nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+
+    pbatch_destroy(&b);
+    free(ic); free(rc); free(mu); free(var);
+    return 1;
+}
+
+// Dormand-Prince 5(4) tableau, where ode_b gives the fifth order solution and ode_e the difference
+// to the embedded fourth order one
+static const ldouble ode_a[7][6] = {
+    {0.L},
+    {1.L/5},
+    {3.L/40, 9.L/40},
+    {44.L/45, -56.L/15, 32.L/9},
+    {19372.L/6561, -25360.L/2187, 64448.L/6561, -212.L/729},
+    {9017.L/3168, -355.L/33, 46732.L/5247, 49.L/176, -5103.L/18656},
+    {35.L/384, 0.L, 500.L/1113, 125.L/192, -2187.L/6784, 11.L/84}
+};
+static const ldouble ode_b[7] = {35.L/384, 0.L, 500.L/1113, 125.L/192, -2187.L/6784, 11.L/84, 0.L};
+static const ldouble ode_e[7] = {71.L/57600, 0.L, -71.L/16695, 71.L/1920, -17253.L/339200,
+                                 22.L/525, -1.L/40};
+
+/*
+ *  Mean-field drift d of the fractions f of agents per state in parallel time, i.e. the expected
+ *  change of the fractions per interaction times the number of agents.
+ */
+static void ode_drift(trtab_t* tr, ullong nstates, ldouble* f, ldouble* d) {
+    for(ullong q = 0; q < nstates; ++q)
+        d[q] = 0.L;
+    for(ullong k = 0; k < trtab_ntrans(tr); ++k) {
+        trans_t* t = trtab_trans(tr, k);
+        ldouble r = f[t->k[0]] * f[t->k[1]];
+        d[t->k[0]] -= r; d[t->k[1]] -= r;
+        d[t->v[0]] += r; d[t->v[1]] += r;
+    }
+}
+
+/*
+ *  Single Dormand-Prince step of length h from f to fn, where k holds the seven stages and g is
+ *  scratch space. Returns the error estimate relative to the tolerance tol, where errors of less
+ *  than tol agents out of n are always accepted.
+ */
+static ldouble ode_step(trtab_t* tr, ullong nstates, ldouble n, ldouble tol, ldouble h,
+                        ldouble* f, ldouble* fn, ldouble** k, ldouble* g) {
+    ode_drift(tr, nstates, f, k[0]);
+    for(int r = 1; r < 7; ++r) {
+        for(ullong q = 0; q < nstates; ++q) {
+            g[q] = f[q];
+            for(int l = 0; l < r; ++l)
+                g[q] += h * ode_a[r][l] * k[l][q];
+        }
+        ode_drift(tr, nstates, g, k[r]);
+    }
+
+    ldouble err = 0.L, e, sc;
+    for(ullong q = 0; q < nstates; ++q) {
+        fn[q] = f[q];
+        e = 0.L;
+        for(int r = 0; r < 7; ++r) {
+            fn[q] += h * ode_b[r] * k[r][q];
+            e     += h * ode_e[r] * k[r][q];
+        }
+        sc  = tol * (POPSIM_MAX(fabsl(f[q]), fabsl(fn[q])) + 1.L/n);
+        err = POPSIM_MAX(err, fabsl(e) / sc);
+    }
+    return err;
+}
+
+/*
+ *  Rounds the fractions f of n agents to the counts dist such that they add up to n.
+ */
+static void ode_round(ullong nstates, ullong n, ldouble* f, ullong* dist) {
+    ldouble cum = 0.L;
+    ullong prev = 0, r;
+    for(ullong q = 0; q < nstates; ++q) {
+        cum += f[q] * n;
+        r = (cum <= prev) ? prev : (cum >= n) ? n : (ullong) roundl(cum);
+        r = POPSIM_MAX(r, prev);
+        dist[q] = (q == nstates-1) ? n - prev : r - prev;
+        prev = r;
+    }
+}
+
+/*
+ *  Whether a state is too small for the mean-field, i.e. it holds less than thresh agents or no
+ *  agents but would be populated by the drift d.
+ */
+static int ode_low(ullong nstates, ullong* dist, ldouble* d, ullong thresh) {
+    for(ullong q = 0; q < nstates; ++q)
+        if((dist[q] > 0 && dist[q] < thresh) || (dist[q] == 0 && d[q] > 0.L))
+            return 1;
+    return 0;
+}
+
+int popsim_ode(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+               void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+               popsim_stop_t* stop, popsim_epoch_t* ep, ullong thresh, ldouble tol,
+               ullong seed1, ullong seed2, ullong seed3) {
+    ullong nconf = snap_nsnap(snap);
+    mbatch_t s;
+    if(mbatch_init(&s, u, nstates, delta, tr, NULL, ep, 1, seed1, seed2, seed3) == 0)
+        return 0;
+
+    ldouble* buf  = (ldouble*) malloc(10 * nstates * sizeof(ldouble));
+    ullong*  dist = (ullong*)  malloc(nstates * sizeof(ullong));
+    if(buf == NULL || dist == NULL) {
+        free(buf); free(dist);
+        mbatch_destroy(&s);
+        return 0;
+    }
+    ldouble* k[7];
+    for(int r = 0; r < 7; ++r)
+        k[r] = buf + r*nstates;
+    ldouble* f  = buf + 7*nstates;
+    ldouble* fn = buf + 8*nstates;
+    ldouble* g  = buf + 9*nstates;
+    ldouble* tmp;
+
+    ullong  n  = bsturn_nmarbles(u);
+    ldouble h  = ODE_H0;
+    ldouble ti = 0.L, hh, err;
+    int     meanfield = 0;
+
+    memcpy(conf, bsturn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong i = 0, target;
+    int stopped = stop_init(stop, bsturn_dist(u), nstates);
+    while(i < nsteps && !stopped) {
+        target = (j < nconf) ? snap_step(snap, j) : nsteps;
+
+        // The fractions are taken from the urn whenever the mean-field is entered
+        if(!meanfield) {
+            for(ullong q = 0; q < nstates; ++q)
+                f[q] = bsturn_cdist(u, q) / (ldouble) n;
+            ode_drift(tr, nstates, f, g);
+            meanfield = !ode_low(nstates, bsturn_dist(u), g, thresh);
+            ti = i;
+        }
+
+        if(!meanfield) {
+            i += mbatch_epoch(&s, target - i);
+        } else {
+            // Steps are in parallel time and never cross the next snapshot
+            hh  = POPSIM_MIN(h, (target - ti) / n);
+            err = ode_step(tr, nstates, n, tol, hh, f, fn, k, g);
+            h   = hh * ((err == 0.L) ? ODE_MAXFAC
+                      : POPSIM_MIN(ODE_MAXFAC, POPSIM_MAX(ODE_MINFAC, 0.9L*powl(err, -0.2L))));
+            if(err > 1.L)
+                continue;
+
+            tmp = f; f = fn; fn = tmp;
+            ti  = (hh == (target - ti) / n) ? target : ti + hh*n;
+            i   = POPSIM_MIN((ullong) ti, target);
+
+            ode_round(nstates, n, f, dist);
+            bsturn_empty(u);
+            bsturn_insert(u, dist);
+            ode_drift(tr, nstates, f, g);
+            meanfield = !ode_low(nstates, dist, g, thresh);
+        }
+
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+        stopped = stop_check(stop, bsturn_dist(u), nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, bsturn_dist(u), nstates * sizeof(ullong));
+
+    mbatch_destroy(&s);
+    free(buf); free(dist);
+    return 1;
+}
+
+/*
+ *  Places the agents of the configuration dist uniformly at random on the vertices and runs the
+ *  steps of popsim_graph, where the states are kept in the array s of the given type.
+ */
+#define GRAPH_RUN(type) do { \
+    type* s = (type*) states; \
+    type  tmp; \
+    ullong k = 0, x; \
+    for(ullong q = 0; q < nstates; ++q) \
+        for(x = 0; x < dist[q]; ++x) \
+            s[k++] = q; \
+    for(k = n-1; k > 0; --k) { \
+        x = mt_urand(&mt, k+1); \
+        tmp = s[k]; s[k] = s[x]; s[x] = tmp; \
+    } \
+    \
+    for(i = 1; i <= nsteps && !stopped; ++i) { \
+        graph_draw(g, &mt, &v, &w); \
+        p1 = s[v]; q1 = s[w]; \
+        (*delta)(p1, q1, &p2, &q2); \
+        if(p1 != p2 || q1 != q2) { \
+            s[v] = p2; s[w] = q2; \
+            cnt[p1]--; cnt[q1]--; cnt[p2]++; cnt[q2]++; \
+            if(stop != NULL && POPSIM_CHANGED(p1, q1, p2, q2)) \
+                stopped = stop_check(stop, cnt, nstates, i); \
+        } \
+        if(j < nconf && i == snap_step(snap, j)) \
+            memcpy(conf + (j++)*nstates, cnt, nstates * sizeof(ullong)); \
+    } \
+} while(0)
+
+int popsim_graph(graph_t* g, ullong* dist, ullong nsteps, ullong nstates, snap_t* snap,
+                 ullong* conf, void (*delta)(ullong, ullong, ullong*, ullong*),
+                 popsim_stop_t* stop, ullong seed) {
+    ullong nconf = snap_nsnap(snap);
+    ullong n = graph_nvert(g);
+
+    // States are stored as narrow as possible, such that more agents fit into the caches
+    size_t width = (nstates < UCHAR_MAX) ? sizeof(ubyte)  : (nstates < USHRT_MAX) ? sizeof(ushort)
+                 : (nstates < UINT_MAX)  ? sizeof(uint)   : sizeof(ullong);
+    void*   states = malloc((n > 0 ? n : 1) * width);
+    ullong* cnt    = (ullong*) malloc(nstates * sizeof(ullong));
+    if(states == NULL || cnt == NULL) {
+        free(states); free(cnt);
+        return 0;
+    }
+
+    mt_t mt;
+    mt_init(&mt, seed);
+
+    memcpy(cnt,  dist, nstates * sizeof(ullong));
+    memcpy(conf, dist, nstates * sizeof(ullong));
+    ullong v, w, p1, q1, p2, q2;
+    ullong i = 1, j = 1;
+    int stopped = stop_init(stop, cnt, nstates);
+    if(width == sizeof(ubyte))
+        GRAPH_RUN(ubyte);
+    else if(width == sizeof(ushort))
+        GRAPH_RUN(ushort);
+    else if(width == sizeof(uint))
+        GRAPH_RUN(uint);
+    else
+        GRAPH_RUN(ullong);
+    stop_end(stop, i-1);
+
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, cnt, nstates * sizeof(ullong));
+
+    free(states); free(cnt);
+    return 1;
+}
+
+int popsim_rounds(linurn_t* u, ullong nrounds, ullong nstates, snap_t* snap, ullong* conf,
+                  void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                  popsim_stop_t* stop, ullong seed1) {
+    ullong nconf = snap_nsnap(snap);
+    ullong* ic = (ullong*) malloc(nstates * sizeof(ullong));
+    ullong* rc = (ullong*) malloc(nstates * sizeof(ullong));
+    if(ic == NULL || rc == NULL) {
+        free(ic); free(rc);
+        return 0;
+    }
+
+    mt_t mt;
+    mt_init(&mt, seed1);
+
+    pbatch_t b;
+    if(pbatch_init(&b, 1, nstates, ic, tr, delta, &mt) == 0) {
+        free(ic); free(rc);
+        return 0;
+    }
+
+    // A uniform perfect matching of all but possibly one agent is a uniform set of initiators,
+    // a uniform set of responders among the rest and a uniform pairing between both
+    ullong m = linurn_nmarbles(u) / 2;
+
+    memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong r = 0;
+    int stopped = stop_init(stop, linurn_dist(u), nstates);
+    while(r < nrounds && !stopped) {
+        mhgeom(&mt, ic, linurn_dist(u), nstates, linurn_nmarbles(u), m);
+        linurn_remove(u, ic);
+        mhgeom(&mt, rc, linurn_dist(u), nstates, linurn_nmarbles(u), m);
+        linurn_remove(u, rc);
+        linurn_insert(u, pbatch_run(&b, &mt, rc, m));
+
+        ++r;
+        if(j < nconf && r == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+        stopped = stop_check(stop, linurn_dist(u), nstates, r);
+    }
+    stop_end(stop, r);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+
+    pbatch_destroy(&b);
+    free(ic); free(rc);
+    return 1;
+}
+
+/*
+ *  Applies the transition of kt to the k agents whose states are in key and inserts them into u.
+ *  Returns non-zero if the configuration changed.
+ */
+static inline int kseq_apply(ktab_t* kt, linurn_t* u, ullong* key) {
+    ullong* val = ktab_lookup(kt, key);
+    ullong* ins = (val != NULL) ? val : key;
+    for(ullong c = 0; c < ktab_k(kt); ++c)
+        linurn_cinsert(u, ins[c], 1);
+    return val != NULL;
+}
+
+void popsim_kseq(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                 ktab_t* kt, popsim_stop_t* stop) {
+    ullong nconf = snap_nsnap(snap);
+    ullong k = ktab_k(kt);
+    ullong key[KTAB_MAXK];
+    memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
+    ullong i, j = 1;
+    int stopped = stop_init(stop, linurn_dist(u), nstates);
+    for(i = 1; i <= nsteps && !stopped; ++i) {
+        for(ullong c = 0; c < k; ++c)
+            key[c] = linurn_draw(u);
+
+        if(kseq_apply(kt, u, key) && stop != NULL)
+            stopped = stop_check(stop, linurn_dist(u), nstates, i);
+
+        if(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+    }
+    stop_end(stop, i-1);
+
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+}
+
+/*
+ *  Batch phase of the k-ary batched simulator. The agents at position c of the m collision-free
+ *  tuples are drawn into pool[c], where the tuples are a uniform matching of the k pools.
+ */
+typedef struct kbatch_t {
+    ullong  nstates;
+    ullong  k;
+    ktab_t* kt;
+
+    ullong* pool;
+    ullong* npool;
+    ullong* row;
+    ullong* out;
+    mt_t*   mt;
+} kbatch_t;
+
+static int kbatch_init(kbatch_t* b, ullong nstates, ktab_t* kt, mt_t* mt) {
+    b->nstates = nstates;
+    b->k       = ktab_k(kt);
+    b->kt      = kt;
+    b->mt      = mt;
+
+    b->pool  = (ullong*) malloc(b->k*nstates * sizeof(ullong));
+    b->npool = (ullong*) malloc(b->k * sizeof(ullong));
+    b->row   = (ullong*) malloc(b->k*nstates * sizeof(ullong));
+    b->out   = (ullong*) malloc(nstates * sizeof(ullong));
+    if(b->pool == NULL || b->npool == NULL || b->row == NULL || b->out == NULL) {
+        free(b->pool); free(b->npool); free(b->row); free(b->out);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ *  Splits the agents at position pos, whose counts are given by row and which complete the tuples
+ *  of a prefix matching the transitions in [lo,hi), by their state. Each state which continues an
+ *  active prefix draws its agents at the next position from the pool, all other prefixes keep
+ *  their states and are left with whatever remains in the pools at last.
+ */
+static void kbatch_rows(kbatch_t* b, ullong pos, ullong lo, ullong hi, ullong* row) {
+    ullong* next = b->row + (pos+1)*b->nstates;
+    ullong  slo, shi, x;
+    for(ullong s = 0; s < b->nstates && lo < hi; ++s) {
+        if((x = row[s]) == 0)
+            continue;
+
+        slo = lo; shi = hi;
+        ktab_narrow(b->kt, &slo, &shi, pos, s);
+        if(slo == shi)
+            continue;
+        lo = shi;
+
+        if(pos+1 == b->k) {
+            ullong* key = ktab_key(b->kt, slo);
+            ullong* val = ktab_val(b->kt, slo);
+            for(ullong c = 0; c < b->k; ++c) {
+                b->out[key[c]] -= x;
+                b->out[val[c]] += x;
+            }
+            continue;
+        }
+
+        ullong* pool = b->pool + (pos+1)*b->nstates;
+        mhgeom(b->mt, next, pool, b->nstates, b->npool[pos+1], x);
+        for(ullong q = 0; q < b->nstates; ++q)
+            pool[q] -= next[q];
+        b->npool[pos+1] -= x;
+        kbatch_rows(b, pos+1, slo, shi, next);
+    }
+}
+
+/*
+ *  Draws m disjoint k-tuples from u, lets them interact and returns the states of all their agents
+ *  afterwards. The returned array is valid until the next run.
+ */
+static ullong* kbatch_run(kbatch_t* b, linurn_t* u, ullong m) {
+    memset(b->out, 0, b->nstates * sizeof(ullong));
+    for(ullong c = 0; c < b->k; ++c) {
+        ullong* pool = b->pool + c*b->nstates;
+        mhgeom(b->mt, pool, linurn_dist(u), b->nstates, linurn_nmarbles(u), m);
+        linurn_remove(u, pool);
+        b->npool[c] = m;
+        for(ullong q = 0; q < b->nstates; ++q)
+            b->out[q] += pool[q];
+    }
+
+    kbatch_rows(b, 0, 0, ktab_ntrans(b->kt), b->pool);
+    return b->out;
+}
+
+static void kbatch_destroy(kbatch_t* b) {
+    free(b->pool); free(b->npool); free(b->row); free(b->out);
+}
+
+int popsim_kbatch(linurn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                  ktab_t* kt, popsim_stop_t* stop, ullong seed1, ullong seed2, ullong seed3) {
+    ullong nconf = snap_nsnap(snap);
+    ullong k = ktab_k(kt);
+    ullong key[KTAB_MAXK];
+    linurn_t* un = linurn_create(seed1, nstates);
+    if(un == NULL) return 0;
+
+    ullong l, r;
+    coll_t c;
+    coll_seed(&c, seed2);
+    coll_setnr(&c, linurn_nmarbles(u), 0);
+
+    mt_t mt;
+    mt_init(&mt, seed3);
+
+    kbatch_t b;
+    if(kbatch_init(&b, nstates, kt, &mt) == 0) {
+        linurn_destroy(un);
+        return 0;
+    }
+
+    memcpy(conf, linurn_dist(u), nstates * sizeof(ullong));
+    ullong j = 1;
+    ullong i = 0, m;
+    int stopped = stop_init(stop, linurn_dist(u), nstates);
+    while(i < nsteps && !stopped) {
+        // A collision among the first k draws is a tuple with a repeated agent
+        do {
+            l = coll_coll(&c);
+        } while(l < k);
+
+        m = ((j < nconf) ? snap_step(snap, j) : nsteps) - i;
+        if(l/k >= m) {
+            linurn_insert(u, kbatch_run(&b, u, m));
+            i += m;
+            while(j < nconf && i == snap_step(snap, j))
+                memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+            stopped = stop_check(stop, linurn_dist(u), nstates, i);
+            continue;
+        }
+
+        linurn_insert(un, kbatch_run(&b, u, l/k));
+
+        // The tuple of the collision has l%k untouched agents before the one drawn from the
+        // agents of the batch, all agents after it are drawn from the whole population
+        r = l%k;
+        for(ullong pos = 0; pos < r; ++pos)
+            key[pos] = linurn_draw(u);
+        key[r] = linurn_draw(un);
+        linurn_insert(u, linurn_dist(un));
+        for(ullong pos = r+1; pos < k; ++pos)
+            key[pos] = linurn_draw(u);
+        kseq_apply(kt, u, key);
+        linurn_empty(un);
+
+        i += l/k+1;
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+        stopped = stop_check(stop, linurn_dist(u), nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, linurn_dist(u), nstates * sizeof(ullong));
+
+    kbatch_destroy(&b);
+    linurn_destroy(un);
+    return 1;
+}
+
+/*
+ *  Partition of the partitioned simulator, which runs its share of the interactions of every
+ *  period on its own urn by epochs of the multi batched simulation.
+ */
+typedef struct ppart_t {
+    pthread_t      thread;
+    bsturn_t*      u;
+    mbatch_t       s;
+    popsim_epoch_t ep;
+    ullong         nagents;
+    ullong         nsteps;
+    ullong*        dist;
+
+    struct ppool_t* pool;
+} ppart_t;
+
+typedef struct ppool_t {
+    ullong   nparts;
+    ullong   nthreads;
+    ppart_t* part;
+
+    int               done;
+    pthread_mutex_t   lock;
+    pthread_barrier_t start, end;
+} ppool_t;
+
+static void ppart_period(ppart_t* p) {
+    for(ullong k = 0; k < p->nsteps;)
+        k += mbatch_epoch(&p->s, p->nsteps - k);
+}
+
+static void* ppart_run(void* data) {
+    ppart_t* p = (ppart_t*) data;
+
+    // As for the workers of the batch phase, done tells whether all threads could be started
+    pthread_mutex_lock(&(p->pool->lock));
+    int done = p->pool->done;
+    pthread_mutex_unlock(&(p->pool->lock));
+    if(done)
+        return NULL;
+
+    for(;;) {
+        pthread_barrier_wait(&(p->pool->start));
+        if(p->pool->done)
+            break;
+        ppart_period(p);
+        pthread_barrier_wait(&(p->pool->end));
+    }
+    return NULL;
+}
+
+/*
+ *  Deals the agents of dist, which is consumed in the process, uniformly at random to the
+ *  partitions, where every partition keeps its number of agents.
+ */
+static void ppool_deal(ppool_t* pool, mt_t* mt, ullong* dist, ullong nstates, ullong nagents) {
+    for(ullong i = 0; i < pool->nparts; ++i) {
+        ppart_t* p = pool->part + i;
+        if(i == pool->nparts-1) {
+            memcpy(p->dist, dist, nstates * sizeof(ullong));
+        } else {
+            mhgeom(mt, p->dist, dist, nstates, nagents, p->nagents);
+            for(ullong q = 0; q < nstates; ++q)
+                dist[q] -= p->dist[q];
+            nagents -= p->nagents;
+        }
+        bsturn_empty(p->u);
+        bsturn_insert(p->u, p->dist);
+    }
+}
+
+static void ppool_destroy(ppool_t* pool) {
+    if(pool->nthreads > 1) {
+        pool->done = 1;
+        pthread_barrier_wait(&(pool->start));
+        for(ullong i = 1; i < pool->nthreads; ++i)
+            pthread_join(pool->part[i].thread, NULL);
+        pthread_barrier_destroy(&(pool->start));
+        pthread_barrier_destroy(&(pool->end));
+        pthread_mutex_destroy(&(pool->lock));
+    }
+    for(ullong i = 0; i < pool->nparts; ++i) {
+        ppart_t* p = pool->part + i;
+        if(p->u != NULL) {
+            mbatch_destroy(&p->s);
+            bsturn_destroy(p->u);
+        }
+        free(p->dist);
+    }
+    free(pool->part);
+}
+
+int popsim_partition(bsturn_t* u, ullong nsteps, ullong nstates, snap_t* snap, ullong* conf,
+                     void (*delta)(ullong, ullong, ullong*, ullong*), trtab_t* tr,
+                     popsim_stop_t* stop, ullong nparts, ldouble period,
+                     ullong seed1, ullong seed2, ullong seed3) {
+    ullong nconf   = snap_nsnap(snap);
+    ullong nagents = bsturn_nmarbles(u);
+    if(nparts == 0 || nparts > nagents/2 || !(period > 0.L)) {
+        errno = EDOM;
+        return 0;
+    }
+
+    ullong* dist = (ullong*) malloc(nstates * sizeof(ullong));
+    if(dist == NULL) return 0;
+    memcpy(dist, bsturn_dist(u), nstates * sizeof(ullong));
+
+    mt_t mt;
+    mt_init(&mt, seed1);
+
+    ppool_t pool;
+    pool.nparts   = nparts;
+    pool.nthreads = 1;
+    pool.done     = 0;
+    if((pool.part = (ppart_t*) calloc(nparts, sizeof(ppart_t))) == NULL) {
+        free(dist);
+        return 0;
+    }
+
+    // Every partition keeps about the same number of agents throughout the simulation
+    ppart_t* p;
+    ullong i, k;
+    for(i = 0; i < nparts; ++i) {
+        p = pool.part + i;
+        p->pool    = &pool;
+        p->nagents = nagents/nparts + (i < nagents%nparts);
+        if((p->dist = (ullong*) malloc(nstates * sizeof(ullong))) == NULL ||
+                (p->u = bsturn_create(mt_rand(&mt), nstates)) == NULL)
+            break;
+        // The collision sampler of the partition is set up for its number of agents, the agents
+        // themselves are dealt at the start of every period
+        popsim_epoch_model(&p->ep, nstates, p->nagents);
+        bsturn_cinsert(p->u, 0, p->nagents);
+        if(mbatch_init(&p->s, p->u, nstates, delta, tr, NULL, &p->ep, 1,
+                       mt_rand(&mt) ^ seed2, mt_rand(&mt) ^ seed3, mt_rand(&mt)) == 0) {
+            bsturn_destroy(p->u);
+            p->u = NULL;
+            break;
+        }
+    }
+    if(i < nparts) {
+        // The failed partition holds at most its snapshot buffer
+        pool.nparts = i+1;
+        ppool_destroy(&pool);
+        free(dist);
+        return 0;
+    }
+
+    // The caller simulates the first partition itself
+    if(nparts > 1) {
+        if(pthread_mutex_init(&(pool.lock), NULL) != 0) {
+            ppool_destroy(&pool);
+            free(dist);
+            errno = EAGAIN;
+            return 0;
+        }
+
+        pthread_mutex_lock(&(pool.lock));
+        for(i = 1; i < nparts; ++i)
+            if(pthread_create(&(pool.part[i].thread), NULL, ppart_run, pool.part+i) != 0)
+                break;
+        pool.nthreads = i;
+
+        int ok = pool.nthreads == nparts;
+        if(ok && pthread_barrier_init(&(pool.start), NULL, nparts) != 0)
+            ok = 0;
+        if(ok && pthread_barrier_init(&(pool.end), NULL, nparts) != 0) {
+            pthread_barrier_destroy(&(pool.start));
+            ok = 0;
+        }
+        pool.done = !ok;
+        pthread_mutex_unlock(&(pool.lock));
+
+        if(!ok) {
+            for(i = 1; i < pool.nthreads; ++i)
+                pthread_join(pool.part[i].thread, NULL);
+            pthread_mutex_destroy(&(pool.lock));
+            pool.nthreads = 1;
+            ppool_destroy(&pool);
+            free(dist);
+            errno = EAGAIN;
+            return 0;
+        }
+    }
+
+    ullong len = (period*nagents >= nsteps) ? nsteps : POPSIM_MAX((ullong) (period*nagents), 1);
+    ullong m;
+
+    memcpy(conf, dist, nstates * sizeof(ullong));
+    ullong j = 1;
+    i = 0;
+    int stopped = stop_init(stop, dist, nstates);
+    while(i < nsteps && !stopped) {
+        // A period ends early at the next snapshot and its interactions are split among the
+        // partitions in proportion to their agents, such that all advance the same parallel time
+        m = POPSIM_MIN(len, ((j < nconf) ? snap_step(snap, j) : nsteps) - i);
+        for(k = 0; k < nparts; ++k) {
+            p = pool.part + k;
+            p->nsteps = (ullong) ((ldouble) m * p->nagents / nagents);
+        }
+        ullong r = m;
+        for(k = 0; k < nparts; ++k)
+            r -= pool.part[k].nsteps;
+        for(k = 0; k < r; ++k)
+            pool.part[k % nparts].nsteps++;
+
+        ppool_deal(&pool, &mt, dist, nstates, nagents);
+        if(nparts > 1)
+            pthread_barrier_wait(&(pool.start));
+        ppart_period(pool.part);
+        if(nparts > 1)
+            pthread_barrier_wait(&(pool.end));
+
+        memset(dist, 0, nstates * sizeof(ullong));
+        for(k = 0; k < nparts; ++k)
+            for(ullong q = 0; q < nstates; ++q)
+                dist[q] += bsturn_dist(pool.part[k].u)[q];
+
+        i += m;
+        while(j < nconf && i == snap_step(snap, j))
+            memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+        stopped = stop_check(stop, dist, nstates, i);
+    }
+    stop_end(stop, i);
+    while(j <= nconf)
+        memcpy(conf + (j++)*nstates, dist, nstates * sizeof(ullong));
+
+    bsturn_empty(u);
+    bsturn_insert(u, dist);
+
+    ppool_destroy(&pool);
+    free(dist);
     return 1;
 }
@@ -0,0 +1,201 @@
+/*
+ *      Filename: snap.c
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "snap.h"
+
+#include <stdlib.h>
+#include <math.h>
+#include <errno.h>
+
+/*
+ *  Allocates a schedule with enough space for nmax snapshots.
+ */
+static snap_t* snap_alloc(ullong nmax) {
+    snap_t* s = (snap_t*) malloc(sizeof(snap_t));
+    if(s == NULL) return NULL;
+
+    s->nsnap = 0;
+    s->times = NULL;
+    if((s->steps = (ullong*) malloc(nmax * sizeof(ullong))) == NULL) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+/*
+ *  Allocates a continuous time schedule with enough space for nmax snapshots.
+ */
+static snap_t* snap_calloc(ullong nmax) {
+    snap_t* s = (snap_t*) malloc(sizeof(snap_t));
+    if(s == NULL) return NULL;
+
+    s->nsnap = 0;
+    s->steps = NULL;
+    if((s->times = (ldouble*) malloc(nmax * sizeof(ldouble))) == NULL) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+/*
+ *  Appends time to the continuous time schedule unless it is not larger than the last time so far.
+ */
+static inline void snap_cpush(snap_t* s, ldouble time) {
+    if(time > 0.L && (s->nsnap == 0 || time > s->times[s->nsnap-1]))
+        s->times[s->nsnap++] = time;
+}
+
+/*
+ *  Appends step to the schedule unless it is not larger than the last step taken so far.
+ */
+static inline void snap_push(snap_t* s, ullong step) {
+    if(step > 0 && (s->nsnap == 0 || step > s->steps[s->nsnap-1]))
+        s->steps[s->nsnap++] = step;
+}
+
+snap_t* snap_equi(ullong nsteps, ullong nsnap) {
+    if(nsnap == 0 || nsnap > nsteps) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    snap_t* s = snap_alloc(nsnap);
+    if(s == NULL) return NULL;
+
+    ullong cstep = nsteps / nsnap;
+    for(ullong j = 1; j < nsnap; ++j)
+        snap_push(s, j*cstep);
+    snap_push(s, nsteps);
+    return s;
+}
+
+snap_t* snap_log(ullong nsteps, ullong nsnap) {
+    if(nsnap == 0 || nsteps == 0) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    snap_t* s = snap_alloc(nsnap < nsteps ? nsnap : nsteps);
+    if(s == NULL) return NULL;
+
+    ldouble lsteps = logl(nsteps);
+    ldouble x;
+    for(ullong j = 1; j < nsnap; ++j) {
+        x = floorl(expl(lsteps * j / nsnap));
+        if(x < nsteps)
+            snap_push(s, (ullong) x);
+    }
+    snap_push(s, nsteps);
+    return s;
+}
+
+snap_t* snap_ptime(ullong nsteps, ullong nagents, ldouble dt) {
+    if(!(dt > 0.L) || nagents == 0 || nsteps == 0) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    // There are at most nsteps/(dt*nagents) snapshots before nsteps but never more than nsteps
+    ldouble dstep = dt * nagents;
+    ldouble nmax  = ceill(nsteps / dstep) + 1.L;
+    snap_t* s = snap_alloc(nmax < nsteps ? (ullong) nmax : nsteps);
+    if(s == NULL) return NULL;
+
+    ldouble x;
+    for(ullong j = 1; (x = floorl(j * dstep)) < nsteps; ++j)
+        snap_push(s, (ullong) x);
+    snap_push(s, nsteps);
+    return s;
+}
+
+static int ullong_cmp(const void* a, const void* b) {
+    ullong x = *(const ullong*) a;
+    ullong y = *(const ullong*) b;
+    return (x > y) - (x < y);
+}
+
+snap_t* snap_list(ullong nsteps, ullong* steplist, ullong nsteplist) {
+    if(nsteps == 0) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    snap_t* s = snap_alloc(nsteplist+1);
+    if(s == NULL) return NULL;
+
+    ullong* sorted = (ullong*) malloc((nsteplist > 0 ? nsteplist : 1) * sizeof(ullong));
+    if(sorted == NULL) {
+        snap_destroy(s);
+        return NULL;
+    }
+
+    for(ullong i = 0; i < nsteplist; ++i)
+        sorted[i] = steplist[i];
+    qsort(sorted, nsteplist, sizeof(ullong), ullong_cmp);
+
+    for(ullong i = 0; i < nsteplist && sorted[i] < nsteps; ++i)
+        snap_push(s, sorted[i]);
+    snap_push(s, nsteps);
+
+    free(sorted);
+    return s;
+}
+
+snap_t* snap_cequi(ldouble tmax, ullong nsnap) {
+    if(nsnap == 0 || !(tmax > 0.L)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    snap_t* s = snap_calloc(nsnap);
+    if(s == NULL) return NULL;
+
+    for(ullong j = 1; j < nsnap; ++j)
+        snap_cpush(s, tmax * j / nsnap);
+    snap_cpush(s, tmax);
+    return s;
+}
+
+static int ldouble_cmp(const void* a, const void* b) {
+    ldouble x = *(const ldouble*) a;
+    ldouble y = *(const ldouble*) b;
+    return (x > y) - (x < y);
+}
+
+snap_t* snap_clist(ldouble tmax, ldouble* timelist, ullong ntimelist) {
+    if(!(tmax > 0.L)) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    snap_t* s = snap_calloc(ntimelist+1);
+    if(s == NULL) return NULL;
+
+    ldouble* sorted = (ldouble*) malloc((ntimelist > 0 ? ntimelist : 1) * sizeof(ldouble));
+    if(sorted == NULL) {
+        snap_destroy(s);
+        return NULL;
+    }
+
+    for(ullong i = 0; i < ntimelist; ++i)
+        sorted[i] = timelist[i];
+    qsort(sorted, ntimelist, sizeof(ldouble), ldouble_cmp);
+
+    for(ullong i = 0; i < ntimelist && sorted[i] < tmax; ++i)
+        snap_cpush(s, sorted[i]);
+    snap_cpush(s, tmax);
+
+    free(sorted);
+    return s;
+}
+
+void snap_destroy(snap_t* s) {
+    free(s->times);
+    free(s->steps);
+    free(s);
+}
@@ -0,0 +1,23 @@
+/*
+ *      Filename: stats.c
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "stats.h"
+
+#include <math.h>
+
+ldouble stats_tquant(ullong df) {
+    static const ldouble tq[] = {12.706L, 4.303L, 3.182L, 2.776L, 2.571L, 2.447L, 2.365L, 2.306L,
+                                 2.262L, 2.228L, 2.201L, 2.179L, 2.160L, 2.145L, 2.131L, 2.120L,
+                                 2.110L, 2.101L, 2.093L, 2.086L, 2.080L, 2.074L, 2.069L, 2.064L,
+                                 2.060L, 2.056L, 2.052L, 2.048L, 2.045L, 2.042L};
+    return (df <= 30) ? tq[df-1] : 1.96L;
+}
+
+ldouble stats_half(stats_t* s) {
+    if(s->n < 2)
+        return INFINITY;
+    return stats_tquant(s->n-1) * sqrtl(stats_var(s) / s->n);
+}
@@ -0,0 +1,98 @@
+/*
+ *      Filename: trtab.c
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "trtab.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <errno.h>
+
+trtab_t* trtab_create(ullong nstates, ullong max_ntrans) {
+    if(nstates == ULLONG_MAX) {
+        errno = EDOM;
+        return NULL;
+    }
+
+    trtab_t* t = (trtab_t*) malloc(sizeof(trtab_t));
+    if(t == NULL) return NULL;
+
+    t->nstates    = nstates;
+    t->ntrans     = 0;
+    t->max_ntrans = max_ntrans;
+
+    if((t->trans  = (trans_t*) malloc((max_ntrans > 0 ? max_ntrans : 1) * sizeof(trans_t))) == NULL)
+        return NULL;
+    if((t->rstart = (ullong*)  calloc(nstates+1, sizeof(ullong))) == NULL)
+        return NULL;
+    if((t->cstart = (ullong*)  calloc(nstates+1, sizeof(ullong))) == NULL)
+        return NULL;
+    if((t->cidx   = (ullong*)  malloc((max_ntrans > 0 ? max_ntrans : 1) * sizeof(ullong))) == NULL)
+        return NULL;
+
+    return t;
+}
+
+int trtab_insert(trtab_t* t, ullong kfst, ullong kscd, ullong vfst, ullong vscd) {
+    if(kfst == vfst && kscd == vscd)
+        return 1;
+    if(t->ntrans >= t->max_ntrans)
+        return 0;
+
+    trans_t* tr = t->trans + t->ntrans++;
+    tr->k[0] = kfst; tr->k[1] = kscd;
+    tr->v[0] = vfst; tr->v[1] = vscd;
+    return 1;
+}
+
+static int trans_cmp(const void* a, const void* b) {
+    const trans_t* ta = (const trans_t*) a;
+    const trans_t* tb = (const trans_t*) b;
+
+    if(ta->k[0] != tb->k[0]) return (ta->k[0] < tb->k[0]) ? -1 : 1;
+    if(ta->k[1] != tb->k[1]) return (ta->k[1] < tb->k[1]) ? -1 : 1;
+    return 0;
+}
+
+void trtab_build(trtab_t* t) {
+    qsort(t->trans, t->ntrans, sizeof(trans_t), trans_cmp);
+
+    for(ullong p = 0; p <= t->nstates; ++p)
+        t->rstart[p] = 0;
+    for(ullong i = 0; i < t->ntrans; ++i)
+        t->rstart[t->trans[i].k[0]+1]++;
+    for(ullong p = 0; p < t->nstates; ++p)
+        t->rstart[p+1] += t->rstart[p];
+
+    // Counting sort by responder keeps the initiators sorted within each column
+    for(ullong q = 0; q <= t->nstates; ++q)
+        t->cstart[q] = 0;
+    for(ullong i = 0; i < t->ntrans; ++i)
+        t->cstart[t->trans[i].k[1]+1]++;
+    for(ullong q = 0; q < t->nstates; ++q)
+        t->cstart[q+1] += t->cstart[q];
+    for(ullong i = 0; i < t->ntrans; ++i)
+        t->cidx[t->cstart[t->trans[i].k[1]]++] = i;
+    for(ullong q = t->nstates; q > 0; --q)
+        t->cstart[q] = t->cstart[q-1];
+    t->cstart[0] = 0;
+}
+
+int trtab_silent(trtab_t* t, ullong* dist) {
+    for(ullong i = 0; i < t->ntrans; ++i) {
+        trans_t* tr = t->trans + i;
+        if(dist[tr->k[0]] > 0 && dist[tr->k[1]] > (tr->k[0] == tr->k[1]))
+            return 0;
+    }
+    return 1;
+}
+
+void trtab_destroy(trtab_t* t) {
+    free(t->trans);
+    free(t->rstart);
+    free(t->cstart);
+    free(t->cidx);
+    free(t);
+}
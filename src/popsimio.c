@@ -23,6 +23,11 @@
 #include "bsturn.h"
 #include "aliurn.h"
 #include "intpmap.h"
+#include "trtab.h"
+#include "ktab.h"
+#include "snap.h"
+#include "graph.h"
+#include "stats.h"
 
 typedef unsigned long long ullong;
 void popsimio_printhelp(char* prog_name);
@@ -33,16 +38,101 @@ void print_ullong_arr(ullong* arr, ullong nel) {
     printf("%llu\n", arr[nel-1]);
 }
 
+// Auto mode calibrates every simulator for at least this many seconds or steps but stops after
+// the maximum number of seconds
+#define PLAN_CALIBSECS 0.01L
+#define PLAN_MAXSECS   0.1L
+#define PLAN_MINSTEPS  16
+
+// Relative error tolerance of a single step of the mean-field simulator
+#define ODE_TOL 1e-6L
+
+// Number of independent splittings whose spread gives the confidence interval of "split"
+#define SPLIT_NBATCH 10
+
+// Minimum number of replicas before the confidence interval of -c may end the replication
+#define REP_MINRUNS 10
+
+#define POPSIM_MIN(x,y) ((x) <= (y) ? (x) : (y))
+
 // Simulation variables
-enum alg_t {ARRAY,LINEAR,BST,ALIAS,BATCH,MBATCH} alg;
+enum alg_t {ARRAY,LINEAR,BST,ALIAS,SMALL,LOCKSTEP,SKIP,BATCH,MBATCH,PMBATCH,HYBRID,LEAP,ODE,GRAPH,
+            ROUNDS,PARTITION,SPLIT,AUTO} alg;
+char*  algname[] = {"array","linear","bst","alias","small","lockstep","skip","batch","mbatch",
+                   "pmbatch","hybrid","leap","ode","graph","rounds","partition","split",
+                   "auto"};
 ullong nsteps   = 1;
 int    verbose  = 0;
 int    hmap     = 0;
+int    hmapset  = 0;
 ullong nsnap    = 1;
 ullong nthreads = 1;
+ullong nworkers = 1;
+ullong ninter   = 1;
+int    emodel   = 0;
+ldouble leapeps = 0.01L;
+ullong odethresh = 1000;
+ldouble period  = 1.L;
+
+// Snapshot schedule variables
+enum snapkind_t {EQUI,LOG,PTIME,LIST} snapkind = EQUI;
+ldouble sdt     = 0.L;
+ullong* slist   = NULL;
+ullong  nslist  = 0;
+snap_t* snap    = NULL;
+
+// Interaction graph variables
+enum graphkind_t {NOGRAPH,RING,GRID,RRG} gkind = NOGRAPH;
+ullong   garg   = 0;
+graph_t* igraph = NULL;
+ullong*  gdist  = NULL;
+
+// Noise variables, where the flipped states are uniform over the list or over all states
+popsim_noise_t  noise;
+popsim_noise_t* inoise = NULL;
+ullong*         nlist  = NULL;
+ullong          nnlist = 0;
+
+// Stop condition variables
+int     esilent = 0;
+ullong* eset    = NULL;
+ullong  neset   = 0;
+
+// Splitting variables, where the level is the number of agents in the states of xset and the
+// trajectories per stage are given by -t
+popsim_split_t split;
+ullong* xset    = NULL;
+ullong  nxset   = 0;
+ullong* xthresh = NULL;
+ullong  nxthresh = 0;
+ullong  ntraj   = 0;
+
+// Sequential replication variables, where replicas are launched on -t threads until the
+// confidence interval of the statistic is narrow relative to its mean or rmax replicas were
+// launched. rres and rfin hold the statistic of every replica and whether it is finished, such
+// that the replicas are accepted in the order of their launch
+enum repstat_t {NOREP,RTIME,RSTATE} rstat = NOREP;
+ullong   rstate = 0;
+ldouble  reps   = 0.L;
+ullong   rmax   = 0;
+stats_t  rstats;
+ldouble* rres   = NULL;
+char*    rfin   = NULL;
+ullong   rnext  = 0;
+ullong   rdone  = 0;
+int      rconv  = 0;
+pthread_mutex_t rlock = PTHREAD_MUTEX_INITIALIZER;
+
+// Output mode variables, where -o prints a line per replica instead of the snapshots and keeps
+// the summary of the stopping times of the replicas that stopped
+enum outmode_t {SNAPS,OSTOP,OFINAL} omode = SNAPS;
+stats_t ostats;
+ullong  omin = ULLONG_MAX;
+ullong  omax = 0;
 
 // Protocol variables
 ullong nstates  = 1;
+ullong karity   = 2;
 ullong ndist    = 1;
 ullong ntrans   = 0;
 
@@ -56,6 +146,8 @@ aliurn_t** aliurn;
 ullong*    larrfst = NULL;
 ullong*    larrscd = NULL;
 intpmap_t* lmap    = NULL;
+trtab_t*   ltab    = NULL;
+ktab_t*    lktab   = NULL;
 
 void (*delta)(ullong, ullong, ullong*, ullong*) = NULL;
 
@@ -81,38 +173,669 @@ typedef struct siminfo_t {
 pthread_t* threads;
 siminfo_t* siminfo;
 ullong**   conf;
+popsim_stop_t* stop = NULL;
 
-void* pthread_sim(void* data) {
-    siminfo_t* i = (siminfo_t*) data;
-    switch(alg) {
-        case ARRAY:  popsim_seqarr(arrurn[i->id], nsteps, nstates, nsnap, conf[i->id], delta); break;
-        case LINEAR: popsim_seqlin(linurn[i->id], nsteps, nstates, nsnap, conf[i->id], delta); break;
-        case BST:    popsim_seqbst(bsturn[i->id], nsteps, nstates, nsnap, conf[i->id], delta); break;
-        case ALIAS:  popsim_seqali(aliurn[i->id], nsteps, nstates, nsnap, conf[i->id], delta); break;
+/*
+ *  Reads the ntrans transitions of k-ary interactions from stdin into the table lktab.
+ */
+int read_ktab() {
+    if(verbose)
+        printf("Enter the transitions as a newline separated list of two space separated state "
+               "tuples of length %llu in turn separated by colons:\n", karity);
+
+    if((lktab = ktab_create(nstates, karity, ntrans)) == NULL) {
+        fprintf(stderr, "Not enough memory for the transition table.\n");
+        return 0;
+    }
+
+    ullong st[2*KTAB_MAXK];
+    char c;
+    for(ullong i = 0; i < ntrans; ++i) {
+        for(ullong j = 0; j < 2*karity; ++j) {
+            c = 0;
+            if(scanf("%llu%c", st+j, &c) != 2 || errno != 0 || st[j] == 0 || st[j] > nstates ||
+                    c != ((j == 2*karity-1) ? '\n' : (j == karity-1) ? ' ' : ':')) {
+                fprintf(stderr, "Transitions must be given such that s_ij are in [1,nstates] or "
+                                "were entered invalidly.\n");
+                return 0;
+            }
+            // Change state because io mapping does not correspond with the implementation mapping
+            st[j]--;
+        }
+        ktab_insert(lktab, st, st+karity);
+    }
+
+    if(ktab_build(lktab) == 0) {
+        fprintf(stderr, "Not enough memory for the transition table.\n");
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ *  Parses the comma separated list "n1,n2,..." of positive integers into the array arr of size n.
+ */
+int parse_list(char* list, ullong** arr, ullong* n) {
+    char* end;
+    do {
+        if((*arr = (ullong*) realloc(*arr, (*n+1) * sizeof(ullong))) == NULL)
+            return 0;
+        errno = 0;
+        if(((*arr)[(*n)++] = strtoull(list, &end, 10)) == 0 || errno != 0 || end == list)
+            return 0;
+        list = end+1;
+    } while(*end == ',');
+    return *end == '\0';
+}
+
+/*
+ *  Level of the splitting, i.e. the number of agents in the states of xset.
+ */
+ldouble xlevel(ullong* dist, ullong nstates, void* arg) {
+    (void) nstates; (void) arg;
+    ullong q = 0;
+    for(ullong i = 0; i < nxset; ++i)
+        q += dist[xset[i]];
+    return q;
+}
+
+void print_split(popsim_split_t* sp) {
+    if(verbose) {
+        for(ullong k = 0; k < sp->nlevels; ++k)
+            printf("Level %.0Lf was crossed by a fraction of %Lg of the trajectories.\n",
+                   sp->thresh[k], sp->cond[k]);
+        printf("Estimated probability %Lg with 95%% confidence interval [%Lg,%Lg].\n",
+               sp->prob, sp->lo, sp->hi);
+    } else {
+        for(ullong k = 0; k < sp->nlevels; ++k)
+            printf("level %.0Lf %Lg\n", sp->thresh[k], sp->cond[k]);
+        printf("split %Lg %Lg %Lg\n", sp->prob, sp->lo, sp->hi);
+    }
+}
+
+void print_rep() {
+    ldouble half = stats_half(&rstats);
+    if(verbose)
+        printf("Estimated mean %Lg with 95%% confidence interval [%Lg,%Lg] after %llu runs, "
+               "which %s the relative half width %Lg.\n", rstats.mean, rstats.mean - half,
+               rstats.mean + half, rstats.n, rconv ? "reached" : "did not reach", reps);
+    else
+        printf("rep %Lg %Lg %Lg %llu %d\n", rstats.mean, rstats.mean - half, rstats.mean + half,
+               rstats.n, rconv);
+}
+
+void print_ostats(ullong nruns) {
+    // Without any stopped run the extremes are still at their initial values
+    if(ostats.n == 0)
+        omin = omax = 0;
+    if(verbose)
+        printf("%llu of %llu runs stopped after %Lg interactions on average with standard "
+               "deviation %Lg, at least %llu and at most %llu.\n", ostats.n, nruns, ostats.mean,
+               sqrtl(stats_var(&ostats)), omin, omax);
+    else
+        printf("stopsum %llu %llu %Lg %Lg %llu %llu\n", ostats.n, nruns, ostats.mean,
+               sqrtl(stats_var(&ostats)), omin, omax);
+}
+
+void print_stop(popsim_stop_t* s) {
+    if(verbose && s->stopped)
+        printf("Stopped after %llu interactions.\n", s->step);
+    else if(verbose)
+        printf("Did not stop within %llu interactions.\n", s->step);
+    else
+        printf("stop %d %llu\n", s->stopped, s->step);
+}
+
+/*
+ *  Runs the simulator a on the urn with index i->id for n steps with the schedule sn, where the
+ *  snapshots are written to cf.
+ */
+void run_sim(enum alg_t a, siminfo_t* i, ullong n, snap_t* sn, ullong* cf, popsim_stop_t* istop) {
+    popsim_epoch_t ep;
+    if(a == MBATCH || a == PMBATCH || a == HYBRID || a == ODE || a == PARTITION) {
+        if(emodel)
+            popsim_epoch_model(&ep, nstates, bsturn_nmarbles(bsturn[i->id]));
+        else
+            popsim_epoch_timed(&ep, nstates, bsturn_nmarbles(bsturn[i->id]));
+    }
+    // Protocols with k-ary interactions have their own simulators
+    if(karity > 2 && a == LINEAR) {
+        popsim_kseq(linurn[i->id], n, nstates, sn, cf, lktab, istop);
+        return;
+    } else if(karity > 2) {
+        if(popsim_kbatch(linurn[i->id], n, nstates, sn, cf, lktab, istop,
+                    i->seed1, i->seed2, i->seed3) == 0) {
+            fprintf(stderr, "Not enough memory to run the k-ary batched simulator.\n");
+            abort();
+        }
+        return;
+    }
+
+    switch(a) {
+        case ARRAY:
+            popsim_seqarr(arrurn[i->id], n, nstates, sn, cf, delta, istop);
+            break;
+        case LINEAR:
+            popsim_seqlin(linurn[i->id], n, nstates, sn, cf, delta, istop);
+            break;
+        case BST:
+            popsim_seqbst(bsturn[i->id], n, nstates, sn, cf, delta, istop);
+            break;
+        case ALIAS:
+            popsim_seqali(aliurn[i->id], n, nstates, sn, cf, delta, istop);
+            break;
+        case SMALL:
+            popsim_seqsmall(linurn[i->id], n, nstates, sn, cf, delta, istop, i->seed1);
+            break;
+        case SKIP:
+            if(popsim_seqskip(linurn[i->id], n, nstates, sn, cf,
+                        ltab, istop, i->seed1, i->seed2) == 0) {
+                fprintf(stderr, "Not enough memory to run the null skipping simulator.\n");
+                abort();
+            }
+            break;
         case BATCH:
-            if(popsim_batch(linurn[i->id], nsteps, nstates, nsnap, conf[i->id],
-                        delta, i->seed1, i->seed2, i->seed3) == 0) {
+            if(popsim_batch(linurn[i->id], n, nstates, sn, cf,
+                        delta, ltab, istop, inoise, i->seed1, i->seed2, i->seed3) == 0) {
                 fprintf(stderr, "Not enough memory to run the batched simulator.\n");
                 abort();
             }
             break;
         case MBATCH:
-            if(popsim_mbatch(bsturn[i->id], nsteps, nstates, nsnap, conf[i->id],
-                        delta, i->seed1, i->seed2, i->seed3) == 0) {
+            if(popsim_mbatch(bsturn[i->id], n, nstates, sn, cf, delta, ltab, istop, inoise,
+                        &ep, i->seed1, i->seed2, i->seed3) == 0) {
                 fprintf(stderr, "Not enough memory to run the multi batched simulator.\n");
                 abort();
             }
             break;
+        case HYBRID:
+            if(popsim_hybrid(bsturn[i->id], n, nstates, sn, cf,
+                        delta, ltab, istop, &ep, i->seed1, i->seed2, i->seed3) == 0) {
+                fprintf(stderr, "Not enough memory to run the hybrid simulator.\n");
+                abort();
+            }
+            break;
+        case LEAP:
+            if(popsim_leap(linurn[i->id], n, nstates, sn, cf,
+                        delta, ltab, istop, leapeps, i->seed1) == 0) {
+                fprintf(stderr, "Not enough memory to run the leaping simulator.\n");
+                abort();
+            }
+            break;
+        case ODE:
+            if(popsim_ode(bsturn[i->id], n, nstates, sn, cf, delta, ltab, istop, &ep,
+                        odethresh, ODE_TOL, i->seed1, i->seed2, i->seed3) == 0) {
+                fprintf(stderr, "Not enough memory to run the mean-field simulator.\n");
+                abort();
+            }
+            break;
+        case ROUNDS:
+            if(popsim_rounds(linurn[i->id], n, nstates, sn, cf,
+                        delta, ltab, istop, i->seed1) == 0) {
+                fprintf(stderr, "Not enough memory to run the round simulator.\n");
+                abort();
+            }
+            break;
+        case GRAPH:
+            if(popsim_graph(igraph, gdist, n, nstates, sn, cf, delta, istop, i->seed1) == 0) {
+                fprintf(stderr, "Not enough memory to run the graph simulator.\n");
+                abort();
+            }
+            break;
+        case PMBATCH:
+            if(popsim_pmbatch(bsturn[i->id], n, nstates, sn, cf, delta, ltab, istop, inoise,
+                        &ep, nworkers, i->seed1, i->seed2, i->seed3) == 0) {
+                fprintf(stderr, "Not enough memory or threads to run the parallel multi batched "
+                                "simulator.\n");
+                abort();
+            }
+            break;
+        case PARTITION:
+            if(popsim_partition(bsturn[i->id], n, nstates, sn, cf, delta, ltab, istop, nworkers,
+                        period, i->seed1, i->seed2, i->seed3) == 0) {
+                fprintf(stderr, "Not enough memory or threads to run the partitioned simulator.\n");
+                abort();
+            }
+            break;
         default: abort();
     }
+}
+
+void* pthread_sim(void* data) {
+    siminfo_t* i = (siminfo_t*) data;
+    // Every thread interleaves the replicas i->id*ninter,... up to the last one
+    if(ninter > 1) {
+        ullong r0 = i->id * ninter;
+        popsim_seqbsti(bsturn + r0, (nthreads-r0 < ninter) ? nthreads-r0 : ninter, nsteps,
+                       nstates, snap, conf + r0, delta, (stop == NULL) ? NULL : stop + r0);
+        return NULL;
+    }
+    run_sim(alg, i, nsteps, snap, conf[i->id], (stop == NULL) ? NULL : stop + i->id);
     return NULL;
 }
 
+/*
+ *  Replaces the urn with index i of the simulator a by a copy with the given seed of the urn with
+ *  index nthreads, which keeps the initial configuration. Returns zero if there was not enough
+ *  memory.
+ */
+int renew_urn(enum alg_t a, ullong i, ullong seed) {
+    switch(a) {
+        case ARRAY:
+            arrurn_destroy(arrurn[i]);
+            return (arrurn[i] = arrurn_copy(arrurn[nthreads], seed)) != NULL;
+        case ALIAS:
+            aliurn_destroy(aliurn[i]);
+            return (aliurn[i] = aliurn_copy(aliurn[nthreads], seed)) != NULL;
+        case LINEAR:
+        case SMALL:
+        case SKIP:
+        case BATCH:
+        case LEAP:
+        case ROUNDS:
+            linurn_destroy(linurn[i]);
+            return (linurn[i] = linurn_copy(linurn[nthreads], seed)) != NULL;
+        case BST:
+        case MBATCH:
+        case PMBATCH:
+        case HYBRID:
+        case ODE:
+        case PARTITION:
+            bsturn_destroy(bsturn[i]);
+            return (bsturn[i] = bsturn_copy(bsturn[nthreads], seed)) != NULL;
+        case GRAPH:
+            return 1;
+        default:
+            abort();
+    }
+}
+
+/*
+ *  Runs replicas on the urn with the index of the thread until the replication of -c is done or
+ *  rmax replicas were launched, where every replica starts from a fresh copy of the initial
+ *  configuration. The replicas of -o are printed and summarized as soon as they finish.
+ */
+void* pthread_rep(void* data) {
+    siminfo_t info = *((siminfo_t*) data);
+    popsim_stop_t* istop = (stop == NULL) ? NULL : stop + info.id;
+    ullong r, seed;
+    ldouble x;
+    while(1) {
+        // The seeds are drawn under the lock since ran is not reentrant
+        pthread_mutex_lock(&rlock);
+        if(rconv || rnext >= rmax) {
+            pthread_mutex_unlock(&rlock);
+            break;
+        }
+        r    = rnext++;
+        seed = ran();
+        info.seed1 = ran(); info.seed2 = ran(); info.seed3 = ran();
+        pthread_mutex_unlock(&rlock);
+
+        if(renew_urn(alg, info.id, seed) == 0) {
+            fprintf(stderr, "Not enough memory for the urn data structure.\n");
+            abort();
+        }
+        run_sim(alg, &info, nsteps, snap, conf[info.id], istop);
+        x = (rstat == RTIME) ? istop->step :
+            (rstat == RSTATE) ? conf[info.id][nsnap*nstates + rstate] : 0.L;
+
+        // Short replicas finish first, thus accepting them in the order of their completion would
+        // bias the statistic towards them, whereas the launch order is independent of the outcome
+        pthread_mutex_lock(&rlock);
+        if(omode == OFINAL)
+            print_ullong_arr(conf[info.id] + nsnap*nstates, nstates);
+        if(omode != SNAPS) {
+            print_stop(istop);
+            if(istop->stopped) {
+                stats_add(&ostats, istop->step);
+                omin = POPSIM_MIN(omin, istop->step);
+                omax = (istop->step > omax) ? istop->step : omax;
+            }
+        }
+        if(rstat != NOREP) {
+            rres[r] = x;
+            rfin[r] = 1;
+        }
+        while(rstat != NOREP && !rconv && rdone < rnext && rfin[rdone]) {
+            stats_add(&rstats, rres[rdone++]);
+            rconv = rstats.n >= REP_MINRUNS && stats_half(&rstats) <= reps * fabsl(rstats.mean);
+        }
+        pthread_mutex_unlock(&rlock);
+    }
+    return NULL;
+}
+
+/*
+ *  Creates n urns of the simulator a holding the configuration dist of nagents agents.
+ */
+int create_urns(enum alg_t a, ullong n, ullong* dist, ullong nagents) {
+    switch(a) {
+        case ARRAY:
+            arrurn = (arrurn_t**) malloc(n * sizeof(arrurn_t*));
+            if((arrurn[0] = arrurn_create(ran(), nstates, nagents)) == NULL) {
+                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                return 0;
+            }
+
+            arrurn_insert(arrurn[0], dist);
+            for(ullong i = 1; i < n; ++i) {
+                if((arrurn[i] = arrurn_copy(arrurn[0], ran())) == NULL) {
+                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                    return 0;
+                }
+            }
+            break;
+        case LINEAR:
+            linurn = (linurn_t**) malloc(n * sizeof(linurn_t*));
+            if((linurn[0] = linurn_create(ran(), nstates)) == NULL) {
+                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                return 0;
+            }
+
+            linurn_insert(linurn[0], dist);
+            for(ullong i = 1; i < n; ++i) {
+                if((linurn[i] = linurn_copy(linurn[0], ran())) == NULL) {
+                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                    return 0;
+                }
+            }
+            break;
+        case BST:
+            bsturn = (bsturn_t**) malloc(n * sizeof(bsturn_t*));
+            if((bsturn[0] = bsturn_create(ran(), nstates)) == NULL) {
+                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                return 0;
+            }
+
+            bsturn_insert(bsturn[0], dist);
+            for(ullong i = 1; i < n; ++i) {
+                if((bsturn[i] = bsturn_copy(bsturn[0], ran())) == NULL) {
+                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                    return 0;
+                }
+            }
+            break;
+        case ALIAS:
+            aliurn = (aliurn_t**) malloc(n * sizeof(aliurn_t*));
+            if((aliurn[0] = aliurn_create(ran(), nstates, 0.8L, 1.5L)) == NULL) {
+                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                return 0;
+            }
+
+            aliurn_insert(aliurn[0], dist);
+            for(ullong i = 1; i < n; ++i) {
+                if((aliurn[i] = aliurn_copy(aliurn[0], ran())) == NULL) {
+                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                    return 0;
+                }
+            }
+            break;
+        case SMALL:
+        case LOCKSTEP:
+        case SKIP:
+        case BATCH:
+        case LEAP:
+        case ROUNDS:
+            linurn = (linurn_t**) malloc(n * sizeof(linurn_t*));
+            if((linurn[0] = linurn_create(ran(), nstates)) == NULL) {
+                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                return 0;
+            }
+
+            linurn_insert(linurn[0], dist);
+            for(ullong i = 1; i < n; ++i) {
+                if((linurn[i] = linurn_copy(linurn[0], ran())) == NULL) {
+                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                    return 0;
+                }
+            }
+            break;
+        case MBATCH:
+        case PMBATCH:
+        case HYBRID:
+        case ODE:
+        case PARTITION:
+        case SPLIT:
+            bsturn = (bsturn_t**) malloc(n * sizeof(bsturn_t*));
+            if((bsturn[0] = bsturn_create(ran(), nstates)) == NULL) {
+                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                return 0;
+            }
+
+            bsturn_insert(bsturn[0], dist);
+            for(ullong i = 1; i < n; ++i) {
+                if((bsturn[i] = bsturn_copy(bsturn[0], ran())) == NULL) {
+                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
+                    return 0;
+                }
+            }
+            break;
+        case GRAPH:
+            if(nagents >= UINT_MAX || (gkind == GRID && nagents % garg != 0) ||
+                    (gkind == RRG && (nagents*garg) % 2 != 0)) {
+                fprintf(stderr, "The graph needs less than 2^32-1 agents, which are a multiple "
+                                "of the rows for \"grid\" and even for odd d for \"rrg\".\n");
+                return 0;
+            }
+            switch(gkind) {
+                case RING: igraph = graph_ring(nagents); break;
+                case GRID: igraph = graph_grid(garg, nagents / garg); break;
+                case RRG:  igraph = graph_rrg(nagents, garg, ran()); break;
+                default: abort();
+            }
+            if(igraph == NULL || graph_nedges(igraph) == 0 || graph_reorder(igraph) == 0 ||
+                    (gdist = (ullong*) malloc(nstates * sizeof(ullong))) == NULL) {
+                fprintf(stderr, "Not enough memory for the interaction graph or it has no "
+                                "edges.\n");
+                return 0;
+            }
+            memcpy(gdist, dist, nstates * sizeof(ullong));
+            break;
+        default:
+            abort();
+    }
+    return 1;
+}
+
+/*
+ *  Destroys the n urns of the simulator a.
+ */
+void destroy_urns(enum alg_t a, ullong n) {
+    for(ullong i = 0; i < n; ++i) {
+        switch(a) {
+            case ARRAY:  arrurn_destroy(arrurn[i]); break;
+            case LINEAR: linurn_destroy(linurn[i]); break;
+            case BST:    bsturn_destroy(bsturn[i]); break;
+            case ALIAS:  aliurn_destroy(aliurn[i]); break;
+            case SMALL:  linurn_destroy(linurn[i]); break;
+            case LOCKSTEP: linurn_destroy(linurn[i]); break;
+            case SKIP:   linurn_destroy(linurn[i]); break;
+            case BATCH:  linurn_destroy(linurn[i]); break;
+            case MBATCH: bsturn_destroy(bsturn[i]); break;
+            case PMBATCH: bsturn_destroy(bsturn[i]); break;
+            case HYBRID: bsturn_destroy(bsturn[i]); break;
+            case LEAP:   linurn_destroy(linurn[i]); break;
+            case ODE:    bsturn_destroy(bsturn[i]); break;
+            case GRAPH:  break;
+            case ROUNDS: linurn_destroy(linurn[i]); break;
+            case PARTITION: bsturn_destroy(bsturn[i]); break;
+            case SPLIT:  bsturn_destroy(bsturn[i]); break;
+            default: abort();
+        }
+    }
+    switch(a) {
+        case ARRAY:  free(arrurn); break;
+        case LINEAR: free(linurn); break;
+        case BST:    free(bsturn); break;
+        case ALIAS:  free(aliurn); break;
+        case SMALL:  free(linurn); break;
+        case LOCKSTEP: free(linurn); break;
+        case SKIP:   free(linurn); break;
+        case BATCH:  free(linurn); break;
+        case MBATCH: free(bsturn); break;
+        case PMBATCH: free(bsturn); break;
+        case HYBRID: free(bsturn); break;
+        case LEAP:   free(linurn); break;
+        case ODE:    free(bsturn); break;
+        case GRAPH:  graph_destroy(igraph); free(gdist); break;
+        case ROUNDS: free(linurn); break;
+        case PARTITION: free(bsturn); break;
+        case SPLIT:  free(bsturn); break;
+        default: abort();
+    }
+}
+
+/*
+ *  Available physical memory in bytes which bounds the memory of the plan chosen by auto.
+ */
+ldouble plan_budget() {
+    return sysconf(_SC_AVPHYS_PAGES) * (ldouble) sysconf(_SC_PAGESIZE);
+}
+
+/*
+ *  The transition array is used if it fits into a quarter of the memory budget since its lookups
+ *  are cheaper than the ones of the map.
+ */
+int plan_hmap() {
+    return nstates >= sqrt(ULLONG_MAX) || 16.L*nstates*nstates > plan_budget() / 4.L;
+}
+
+/*
+ *  Estimated memory in bytes kept by a single run of the simulator a excluding the transitions.
+ */
+ldouble plan_memory(enum alg_t a, ullong nagents) {
+    ldouble ns = nstates * (ldouble) sizeof(ullong);
+    ldouble mem;
+    switch(a) {
+        case ARRAY:
+            mem = nagents * (ldouble) (nstates < UCHAR_MAX ? 1 : nstates < USHRT_MAX ? 2 :
+                                       nstates < UINT_MAX  ? 4 : 8);
+            break;
+        case LINEAR: mem = ns; break;
+        case BST:    mem = 4*ns; break;
+        case ALIAS:  mem = 6*ns; break;
+        case SMALL:  mem = ns; break;
+        case LOCKSTEP: mem = ns; break;
+        case SKIP:   mem = ns + 4.L*ntrans*sizeof(ullong); break;
+        case BATCH:  mem = 9*ns; break;
+        case LEAP:   mem = 11*ns; break;
+        case ROUNDS: mem = 9*ns; break;
+        case MBATCH: 
+        case PMBATCH:
+        case HYBRID: mem = 15*ns; break;
+        case ODE:    mem = 26*ns; break;
+        case PARTITION: mem = 18*ns*nworkers; break;
+        case SPLIT:  mem = 8*ns*ntraj; break;
+        case GRAPH:  mem = nagents * (ldouble) (nstates < UCHAR_MAX ? 1 : nstates < USHRT_MAX ? 2 :
+                                                nstates < UINT_MAX  ? 4 : 8) + 2*ns; break;
+        default: abort();
+    }
+    return mem + (nsnap+1)*ns;
+}
+
+/*
+ *  Predicts the seconds of a run of the simulator a for nsteps steps by running it on the
+ *  configuration dist for twice as many steps as before until the steps dominate the setup of a
+ *  run, i.e. the run takes at least PLAN_CALIBSECS seconds and half again as long as the previous
+ *  one, or all nsteps steps were run. The seconds per interaction are given by the difference of
+ *  the last two runs and the rest is counted as setup, such as the snapshots. Returns a negative
+ *  value if the simulator could not be run.
+ */
+ldouble plan_calibrate(enum alg_t a, ullong* dist, ullong nagents) {
+    ullong* cf = (ullong*) malloc(2*nstates * sizeof(ullong));
+    if(cf == NULL || create_urns(a, 1, dist, nagents) == 0) {
+        free(cf);
+        return -1.L;
+    }
+
+    siminfo_t info;
+    info.id = 0;
+    info.seed1 = ran(); info.seed2 = ran(); info.seed3 = ran();
+
+    snap_t* sn;
+    struct timespec start, end;
+    ldouble secs = 0.L, psecs = 0.L;
+    ullong n = POPSIM_MIN(PLAN_MINSTEPS, nsteps), pn = 0;
+    for(;;) {
+        if((sn = snap_equi(n, 1)) == NULL) {
+            secs = -1.L;
+            break;
+        }
+        memset(cf, 0, 2*nstates * sizeof(ullong));
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        run_sim(a, &info, n, sn, cf, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        snap_destroy(sn);
+
+        secs = (end.tv_sec-start.tv_sec) + (end.tv_nsec-start.tv_nsec)*1e-9L;
+        if((pn > 0 && ((secs >= PLAN_CALIBSECS && secs >= 1.5L*psecs) || secs >= PLAN_MAXSECS)) ||
+                n == nsteps)
+            break;
+        psecs = secs;
+        pn    = n;
+        n = (n >= nsteps/2) ? nsteps : 2*n;
+    }
+
+    destroy_urns(a, 1);
+    free(cf);
+    if(secs < 0.L)
+        return secs;
+    if(n == nsteps || pn == 0)
+        return secs;
+
+    ldouble cost  = (secs > psecs) ? (secs-psecs) / (n-pn) : secs / n;
+    ldouble setup = (secs > cost*n) ? secs - cost*n : 0.L;
+    return setup + cost*nsteps;
+}
+
+/*
+ *  Chooses the fastest simulator which fits into the memory budget by calibrating all candidates
+ *  on the configuration dist and prints the plan to stderr. Returns zero if no simulator fits.
+ */
+int plan(ullong* dist, ullong nagents) {
+    enum alg_t cand[] = {ARRAY,LINEAR,BST,ALIAS,SMALL,SKIP,BATCH,MBATCH,HYBRID};
+    ldouble budget = plan_budget();
+    ldouble shared = (hmap ? 48.L*ntrans : 16.L*nstates*nstates) + 48.L*ntrans + 16.L*nstates;
+    ldouble mem, cost, bmem = 0.L, bcost = -1.L;
+
+    for(ullong i = 0; i < sizeof(cand)/sizeof(cand[0]); ++i) {
+        if(cand[i] == SKIP && nagents >= ULLONG_MAX/nagents)
+            continue;
+        if(cand[i] == SMALL && nstates > POPSIM_SMALL_MAX)
+            continue;
+        if((mem = shared + nthreads*plan_memory(cand[i], nagents)) > budget)
+            continue;
+        if((cost = plan_calibrate(cand[i], dist, nagents)) < 0.L)
+            continue;
+
+        if(verbose)
+            fprintf(stderr, "Calibrated \"%s\" with %.3Lg s per run and %.3Lg MiB.\n",
+                    algname[cand[i]], cost, mem / (1 << 20));
+        if(bcost < 0.L || cost < bcost) {
+            alg   = cand[i];
+            bcost = cost;
+            bmem  = mem;
+        }
+    }
+
+    if(bcost < 0.L) {
+        fprintf(stderr, "No simulator fits into the available memory.\n");
+        return 0;
+    }
+    fprintf(stderr, "Plan: sim \"%s\" with delta \"%s\" predicted to take %.3Lg s using %.3Lg "
+            "MiB of memory.\n", algname[alg], hmap ? "map" : "array", bcost * nthreads,
+            bmem / (1 << 20));
+    return 1;
+}
+
 int main(int argc, char* argv[]) {
     // Read command line options
     char c;
+    char* nend;
     int flag;
-    while((flag = getopt(argc, argv, "hvd:s:t:")) >= 0) {
+    while((flag = getopt(argc, argv, "hvc:d:e:g:i:k:l:m:n:o:p:r:s:t:w:x:")) >= 0) {
         switch(flag) {
             case 'h':
                 popsimio_printhelp(argv[0]);
@@ -120,7 +843,30 @@ int main(int argc, char* argv[]) {
             case 'v':
                 verbose = 1;
                 break;
+            case 'c':
+                if(strncmp(optarg, "time:", 5) == 0) {
+                    rstat  = RTIME;
+                    optarg += 5;
+                } else if(strncmp(optarg, "state:", 6) == 0) {
+                    rstat  = RSTATE;
+                    rstate = strtoull(optarg+6, &nend, 10);
+                    optarg = (*nend == ':' && rstate > 0) ? nend+1 : nend;
+                }
+                if(rstat != NOREP) {
+                    reps = strtold(optarg, &nend);
+                    if(*nend == ':' && reps > 0.L)
+                        rmax = strtoull(nend+1, &nend, 10);
+                }
+                if(rstat == NOREP || rmax < 2 || rmax == ULLONG_MAX || *nend != '\0' ||
+                        errno != 0) {
+                    fprintf(stderr, "Option -%c requires rep to be either \"time:eps:nmax\" or "
+                            "\"state:s:eps:nmax\" with positive eps and nmax in [2,2^64-1).\n",
+                            optopt);
+                    return -1;
+                }
+                break;
             case 'd':
+                hmapset = 1;
                 if(strcmp(optarg, "array") == 0) {
                     hmap = 0;
                 } else if(strcmp(optarg, "map") == 0) {
@@ -131,13 +877,136 @@ int main(int argc, char* argv[]) {
                     return -1;
                 }
                 break;
-            case 's':
-                if((nsnap = strtoull(optarg, NULL, 10)) == 0 || errno != 0 || nsnap == ULLONG_MAX) {
-                    fprintf(stderr, "Option -%c requires nsnap as an integer argument in "
-                           "[1,nsteps].\n", optopt);
+            case 'e':
+                if(strcmp(optarg, "silent") == 0) {
+                    esilent = 1;
+                } else if(strncmp(optarg, "set:", 4) == 0 && eset == NULL) {
+                    if(parse_list(optarg+4, &eset, &neset) == 0) {
+                        fprintf(stderr, "Option -%c requires the set to be a comma separated "
+                                "list of states in [1,nstates].\n", optopt);
+                        return -1;
+                    }
+                } else {
+                    fprintf(stderr, "Option -%c requires cond to be either \"silent\" or "
+                            "\"set:s1,s2,...\" where the set is given at most once.\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'g':
+                if(strcmp(optarg, "ring") == 0) {
+                    gkind = RING;
+                } else if(strncmp(optarg, "grid:", 5) == 0) {
+                    gkind = GRID;
+                    garg  = strtoull(optarg+5, NULL, 10);
+                } else if(strncmp(optarg, "rrg:", 4) == 0) {
+                    gkind = RRG;
+                    garg  = strtoull(optarg+4, NULL, 10);
+                }
+                if(gkind == NOGRAPH || (gkind != RING && garg == 0) || errno != 0) {
+                    fprintf(stderr, "Option -%c requires topo to be either \"ring\", "
+                            "\"grid:rows\" or \"rrg:d\" with positive integers.\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'i':
+                if((ninter = strtoull(optarg, NULL, 10)) == 0 || ninter > BSTURN_MAXDRAW ||
+                        errno != 0) {
+                    fprintf(stderr, "Option -%c requires ninter as an integer argument in "
+                            "[1,%d].\n", optopt, BSTURN_MAXDRAW);
+                    return -1;
+                }
+                break;
+            case 'k':
+                if((karity = strtoull(optarg, NULL, 10)) < 2 || karity > KTAB_MAXK ||
+                        errno != 0) {
+                    fprintf(stderr, "Option -%c requires k as an integer argument in [2,%d].\n",
+                            optopt, KTAB_MAXK);
+                    return -1;
+                }
+                break;
+            case 'l':
+                if(!((leapeps = strtold(optarg, NULL)) > 0.L) || errno != 0) {
+                    fprintf(stderr, "Option -%c requires eps to be a positive number.\n",
+                            optopt);
+                    return -1;
+                }
+                break;
+            case 'm':
+                if((odethresh = strtoull(optarg, NULL, 10)) == 0 || errno != 0 ||
+                        odethresh == ULLONG_MAX) {
+                    fprintf(stderr, "Option -%c requires thresh as an integer argument in "
+                           "[1,2^64-1).\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'n':
+                inoise = &noise;
+                noise.eps = strtold(optarg, &nend);
+                if(errno != 0 || nend == optarg || !(noise.eps >= 0.L && noise.eps <= 1.L) ||
+                        (*nend != '\0' && (*nend != ':' || parse_list(nend+1, &nlist, &nnlist)
+                                           == 0))) {
+                    fprintf(stderr, "Option -%c requires noise to be either \"eps\" or "
+                            "\"eps:s1,s2,...\" with eps in [0,1].\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'o':
+                if(strcmp(optarg, "stop") == 0) {
+                    omode = OSTOP;
+                } else if(strcmp(optarg, "final") == 0) {
+                    omode = OFINAL;
+                } else {
+                    fprintf(stderr, "Option -%c requires out to be either \"stop\" or "
+                            "\"final\".\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'p':
+                if(strcmp(optarg, "timed") == 0) {
+                    emodel = 0;
+                } else if(strcmp(optarg, "model") == 0) {
+                    emodel = 1;
+                } else {
+                    fprintf(stderr, "Option -%c requires policy to be either \"timed\" or "
+                            "\"model\".\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'r':
+                if(!((period = strtold(optarg, NULL)) > 0.L) || errno != 0) {
+                    fprintf(stderr, "Option -%c requires period to be a positive number.\n",
+                            optopt);
                     return -1;
                 }
                 break;
+            case 's':
+                if(strncmp(optarg, "ptime:", 6) == 0) {
+                    snapkind = PTIME;
+                    if(!((sdt = strtold(optarg+6, NULL)) > 0.L) || errno != 0) {
+                        fprintf(stderr, "Option -%c requires dt to be a positive number.\n",
+                                optopt);
+                        return -1;
+                    }
+                } else if(strncmp(optarg, "list:", 5) == 0) {
+                    snapkind = LIST;
+                    if(parse_list(optarg+5, &slist, &nslist) == 0) {
+                        fprintf(stderr, "Option -%c requires the list to be a comma separated "
+                                "list of steps in [1,nsteps].\n", optopt);
+                        return -1;
+                    }
+                } else {
+                    if(strncmp(optarg, "log:", 4) == 0) {
+                        snapkind = LOG;
+                        optarg += 4;
+                    }
+                    if((nsnap = strtoull(optarg, NULL, 10)) == 0 || errno != 0 ||
+                            nsnap == ULLONG_MAX) {
+                        fprintf(stderr, "Option -%c requires nsnap as an integer argument in "
+                               "[1,nsteps].\n", optopt);
+                        return -1;
+                    }
+                }
+                break;
             case 't':
                 if((nthreads = strtoull(optarg, NULL, 10)) == 0 || errno != 0 ||
                         nthreads == ULLONG_MAX) {
@@ -146,16 +1015,72 @@ int main(int argc, char* argv[]) {
                     return -1;
                 }
                 break;
+            case 'w':
+                if((nworkers = strtoull(optarg, NULL, 10)) == 0 || errno != 0 ||
+                        nworkers == ULLONG_MAX) {
+                    fprintf(stderr, "Option -%c requires nworkers as an integer argument in "
+                           "[1,2^64-1).\n", optopt);
+                    return -1;
+                }
+                break;
+            case 'x':
+                if((nend = strchr(optarg, ':')) != NULL && xset == NULL) {
+                    *nend = '\0';
+                    if(parse_list(optarg, &xset, &nxset) && parse_list(nend+1, &xthresh, &nxthresh))
+                        break;
+                }
+                fprintf(stderr, "Option -%c requires event to be \"s1,s2,...:l1,l2,...\" with "
+                        "states in [1,nstates] and positive levels.\n", optopt);
+                return -1;
             case '?':
-                if(optopt == 'd')
+                if(optopt == 'c')
+                    fprintf(stderr, "Option -%c requires rep to be either \"time:eps:nmax\" or "
+                            "\"state:s:eps:nmax\".\n", optopt);
+                else if(optopt == 'd')
                     fprintf(stderr, "Option -%c requires delta to be either \"array\" or \"map\".",
                             optopt);
+                else if(optopt == 'e')
+                    fprintf(stderr, "Option -%c requires cond to be either \"silent\" or "
+                            "\"set:s1,s2,...\".\n", optopt);
+                else if(optopt == 'g')
+                    fprintf(stderr, "Option -%c requires topo to be either \"ring\", "
+                            "\"grid:rows\" or \"rrg:d\".\n", optopt);
+                else if(optopt == 'i')
+                    fprintf(stderr, "Option -%c requires ninter as an integer argument in "
+                            "[1,%d].\n", optopt, BSTURN_MAXDRAW);
+                else if(optopt == 'k')
+                    fprintf(stderr, "Option -%c requires k as an integer argument in [2,%d].\n",
+                            optopt, KTAB_MAXK);
+                else if(optopt == 'l')
+                    fprintf(stderr, "Option -%c requires eps to be a positive number.\n",
+                            optopt);
+                else if(optopt == 'm')
+                    fprintf(stderr, "Option -%c requires thresh as an integer argument in "
+                           "[1,2^64-1).\n", optopt);
+                else if(optopt == 'n')
+                    fprintf(stderr, "Option -%c requires noise to be either \"eps\" or "
+                            "\"eps:s1,s2,...\" with eps in [0,1].\n", optopt);
+                else if(optopt == 'o')
+                    fprintf(stderr, "Option -%c requires out to be either \"stop\" or "
+                            "\"final\".\n", optopt);
+                else if(optopt == 'p')
+                    fprintf(stderr, "Option -%c requires policy to be either \"timed\" or "
+                            "\"model\".\n", optopt);
+                else if(optopt == 'r')
+                    fprintf(stderr, "Option -%c requires period to be a positive number.\n",
+                            optopt);
                 else if(optopt == 's')
-                    fprintf(stderr, "Option -%c requires nsnap as an integer argument in "
-                           "[1,nsteps].\n", optopt);
+                    fprintf(stderr, "Option -%c requires sched to be either \"nsnap\", "
+                           "\"log:nsnap\", \"ptime:dt\" or \"list:n1,n2,...\".\n", optopt);
                 else if(optopt == 't')
                     fprintf(stderr, "Option -%c requires nthreads as an integer argument in "
                            "[1,2^64-1).\n", optopt);
+                else if(optopt == 'w')
+                    fprintf(stderr, "Option -%c requires nworkers as an integer argument in "
+                           "[1,2^64-1).\n", optopt);
+                else if(optopt == 'x')
+                    fprintf(stderr, "Option -%c requires event to be \"s1,s2,...:l1,l2,...\".\n",
+                            optopt);
                 else if(isprint(optopt))
                     fprintf(stderr, "Unknown option `-%c'.\n", optopt);
                 else
@@ -175,18 +1100,85 @@ int main(int argc, char* argv[]) {
     else if(strcmp(argv[optind], "linear") == 0) alg = LINEAR;
     else if(strcmp(argv[optind], "bst")    == 0) alg = BST;
     else if(strcmp(argv[optind], "alias")  == 0) alg = ALIAS;
+    else if(strcmp(argv[optind], "small")  == 0) alg = SMALL;
+    else if(strcmp(argv[optind], "lockstep") == 0) alg = LOCKSTEP;
+    else if(strcmp(argv[optind], "skip")   == 0) alg = SKIP;
     else if(strcmp(argv[optind], "batch")  == 0) alg = BATCH;
     else if(strcmp(argv[optind], "mbatch") == 0) alg = MBATCH;
+    else if(strcmp(argv[optind], "pmbatch") == 0) alg = PMBATCH;
+    else if(strcmp(argv[optind], "hybrid") == 0) alg = HYBRID;
+    else if(strcmp(argv[optind], "leap")   == 0) alg = LEAP;
+    else if(strcmp(argv[optind], "ode")    == 0) alg = ODE;
+    else if(strcmp(argv[optind], "graph")  == 0) alg = GRAPH;
+    else if(strcmp(argv[optind], "rounds") == 0) alg = ROUNDS;
+    else if(strcmp(argv[optind], "partition") == 0) alg = PARTITION;
+    else if(strcmp(argv[optind], "split")  == 0) alg = SPLIT;
+    else if(strcmp(argv[optind], "auto")   == 0) alg = AUTO;
     else {
         fprintf(stderr, "The specified algorithm must be either \"array\", \"linear\", \"bst\", "
-                "\"alias\",\"batch\" or \"mbatch\".\n");
+                "\"alias\", \"small\", \"lockstep\", \"skip\", \"batch\", \"mbatch\", "
+                "\"pmbatch\", \"hybrid\", \"leap\", \"ode\", \"graph\", \"rounds\", \"partition\", "
+                "\"split\" or \"auto\".\n");
         return -1;
     }
     if((nsteps = strtoull(argv[optind+1], NULL, 10)) == 0 || errno != 0 || nsteps == ULLONG_MAX) {
         fprintf(stderr, "The number of steps needs to be an integer in [1,2^64-1).\n");
         return -1;
     }
-    if(nsnap > nsteps) {
+    if((alg == GRAPH) != (gkind != NOGRAPH)) {
+        fprintf(stderr, "The simulator \"graph\" requires the option -g and vice versa.\n");
+        return -1;
+    }
+    if((alg == SPLIT) != (xset != NULL)) {
+        fprintf(stderr, "The simulator \"split\" requires the option -x and vice versa.\n");
+        return -1;
+    }
+    for(ullong i = 1; i < nxthresh; ++i) {
+        if(xthresh[i] <= xthresh[i-1]) {
+            fprintf(stderr, "The levels of the event need to be increasing.\n");
+            return -1;
+        }
+    }
+    // The splitting runs all trajectories on a single urn
+    if(alg == SPLIT && nthreads < 2) {
+        fprintf(stderr, "The simulator \"split\" requires at least 2 trajectories, see -t.\n");
+        return -1;
+    } else if(alg == SPLIT) {
+        ntraj    = nthreads;
+        nthreads = 1;
+    }
+    if((rstat != NOREP || omode != SNAPS) && (alg == LOCKSTEP || alg == SPLIT || ninter > 1)) {
+        fprintf(stderr, "The simulators \"lockstep\" and \"split\" as well as -i do not "
+                        "support -c and -o.\n");
+        return -1;
+    }
+    if(omode != SNAPS && !esilent && neset == 0) {
+        fprintf(stderr, "The option -o requires the option -e.\n");
+        return -1;
+    }
+    // Without -c, the replicas of -o are shared by a pool of at most one thread per processor
+    // that reuses its urn and snapshots, such that their memory does not grow with the replicas
+    if(omode != SNAPS && rstat == NOREP) {
+        rmax     = nthreads;
+        nthreads = POPSIM_MIN(nthreads, (ullong) sysconf(_SC_NPROCESSORS_ONLN));
+    }
+    if(rstat == RTIME && !esilent && neset == 0) {
+        fprintf(stderr, "The statistic \"time\" of -c requires the option -e.\n");
+        return -1;
+    }
+    if(ninter > 1 && alg != BST) {
+        fprintf(stderr, "Only the simulator \"bst\" supports -i.\n");
+        return -1;
+    }
+    if(inoise != NULL && alg != BATCH && alg != MBATCH && alg != PMBATCH) {
+        fprintf(stderr, "Only the simulators \"batch\", \"mbatch\" and \"pmbatch\" support -n.\n");
+        return -1;
+    }
+    if(karity > 2 && alg != LINEAR && alg != BATCH) {
+        fprintf(stderr, "Only the simulators \"linear\" and \"batch\" support -k.\n");
+        return -1;
+    }
+    if(snapkind == EQUI && nsnap > nsteps) {
         fprintf(stderr, "The number of snapshots must be smaller or equal than the number of "
                         "steps.\n");
         return -1;
@@ -198,7 +1190,8 @@ int main(int argc, char* argv[]) {
                "transitions given as a space separated list ended by a newline:\n");
     }
     if(scanf("%llu", &nstates) != 1 || errno != 0 || nstates == 0 ||
-            (!hmap && nstates >= sqrt(ULLONG_MAX)) || nstates >= ULLONG_MAX/(nsnap+1)) {
+            (!hmap && (alg != AUTO || hmapset) && nstates >= sqrt(ULLONG_MAX)) ||
+            nstates >= ULLONG_MAX/(nsnap+1)) {
         fprintf(stderr, "The number of states needs to be an integer in [1,(2^64-1)/(nsnap+1)] if "
                         "delta is \"map\" or in [1,min(sqrt(2^64-1),(2^64-1)/(nsnap+1))] if delta "
                         "is \"array\" or it was entered invalidly.\n");
@@ -215,6 +1208,44 @@ int main(int argc, char* argv[]) {
                         "or was entered invalidly.\n");
         return -1;
     }
+    if(alg == AUTO && !hmapset)
+        hmap = plan_hmap();
+
+    if(nnlist > 0) {
+        if((noise.target = (ldouble*) calloc(nstates, sizeof(ldouble))) == NULL) {
+            fprintf(stderr, "Not enough memory for the noise targets.\n");
+            return -1;
+        }
+        for(ullong i = 0; i < nnlist; ++i) {
+            if(nlist[i] > nstates) {
+                fprintf(stderr, "The states of the noise targets need to be in [1,nstates].\n");
+                return -1;
+            }
+            noise.target[nlist[i]-1] += 1.L / nnlist;
+        }
+    }
+
+    for(ullong i = 0; i < neset; ++i) {
+        if(eset[i] > nstates) {
+            fprintf(stderr, "The states of the stop condition set need to be in [1,nstates].\n");
+            return -1;
+        }
+        // Change state because io mapping does not correspond with the implementation mapping
+        --eset[i];
+    }
+    if(rstat == RSTATE && rstate > nstates) {
+        fprintf(stderr, "The state of the statistic of -c needs to be in [1,nstates].\n");
+        return -1;
+    } else if(rstat == RSTATE) {
+        rstate--;
+    }
+    for(ullong i = 0; i < nxset; ++i) {
+        if(xset[i] > nstates) {
+            fprintf(stderr, "The states of the event need to be in [1,nstates].\n");
+            return -1;
+        }
+        --xset[i];
+    }
 
     // Read initial configuration and initialize the urn data structure
     if(verbose)
@@ -246,161 +1277,139 @@ int main(int argc, char* argv[]) {
         dist[--s] += q;
     }
 
-    if(nagents < 2) {
-        fprintf(stderr, "The total number of agents needs to be larger than 1.\n");
+    if(nagents < karity) {
+        fprintf(stderr, "The total number of agents needs to be at least max(2,k).\n");
+        return -1;
+    }
+    if(alg == PARTITION && nagents/2 < nworkers) {
+        fprintf(stderr, "The total number of agents needs to be at least 2*nworkers for "
+                        "\"partition\".\n");
+        return -1;
+    }
+    if(alg == SMALL && nstates > POPSIM_SMALL_MAX) {
+        fprintf(stderr, "The simulator \"small\" requires at most %d states.\n", POPSIM_SMALL_MAX);
+        return -1;
+    }
+    if(alg == LOCKSTEP && (nagents >= (1LLU << 31) || nstates > 0xFFFF)) {
+        fprintf(stderr, "The simulator \"lockstep\" requires less than 2^31 agents and less than "
+                        "2^16 states.\n");
+        return -1;
+    }
+    if(alg == SKIP && nagents >= ULLONG_MAX/nagents) {
+        fprintf(stderr, "The total number of agents needs to be smaller than 2^32 for \"skip\".\n");
         return -1;
     }
 
-    sran(time(NULL));
-    switch(alg) {
-        case ARRAY:
-            arrurn = (arrurn_t**) malloc(nthreads * sizeof(arrurn_t*));
-            if((arrurn[0] = arrurn_create(ran(), nstates, nagents)) == NULL) {
-                fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                return -1;
-            }
+    // Read transitions, where k-ary interactions only need their sparse table
+    if(karity > 2) {
+        if(read_ktab() == 0)
+            return -1;
+    } else {
+        if(verbose)
+            printf("Enter the transitions as a newline separated list of two space separated state "
+                   "pairs in turn separated by a colon:\n");
 
-            arrurn_insert(arrurn[0], dist);
-            for(ullong i = 1; i < nthreads; ++i) {
-                if((arrurn[i] = arrurn_copy(arrurn[0], ran())) == NULL) {
-                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                    return -1;
-                }
-            }
-            break;
-        case LINEAR:
-            linurn = (linurn_t**) malloc(nthreads * sizeof(linurn_t*));
-            if((linurn[0] = linurn_create(ran(), nstates)) == NULL) {
-                fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                return -1;
-            }
+        if((ltab = trtab_create(nstates, ntrans)) == NULL) {
+            fprintf(stderr, "Not enough memory for the transition table.\n");
+            return -1;
+        }
 
-            linurn_insert(linurn[0], dist);
-            for(ullong i = 1; i < nthreads; ++i) {
-                if((linurn[i] = linurn_copy(linurn[0], ran())) == NULL) {
-                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                    return -1;
-                }
-            }
-            break;
-        case BST:
-            bsturn = (bsturn_t**) malloc(nthreads * sizeof(bsturn_t*));
-            if((bsturn[0] = bsturn_create(ran(), nstates)) == NULL) {
-                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+        if(hmap) {
+            delta = hlookup;
+            if((lmap = intpmap_create(ntrans, nagents-1)) == NULL) {
+                fprintf(stderr, "Not enough memory for the transition map.\n");
                 return -1;
             }
-
-            bsturn_insert(bsturn[0], dist);
-            for(ullong i = 1; i < nthreads; ++i) {
-                if((bsturn[i] = bsturn_copy(bsturn[0], ran())) == NULL) {
-                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                    return -1;
-                }
-            }
-            break;
-        case ALIAS:
-            aliurn = (aliurn_t**) malloc(nthreads * sizeof(aliurn_t*));
-            if((aliurn[0] = aliurn_create(ran(), nstates, 0.8L, 1.5L)) == NULL) {
-                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+        } else {
+            delta = alookup;
+            if((larrfst = (ullong*) malloc(nstates*nstates * sizeof(ullong))) == NULL) {
+                fprintf(stderr, "Not enough memory for the transition array.\n");
                 return -1;
             }
-
-            aliurn_insert(aliurn[0], dist);
-            for(ullong i = 1; i < nthreads; ++i) {
-                if((aliurn[i] = aliurn_copy(aliurn[0], ran())) == NULL) {
-                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                    return -1;
-                }
-            }
-            break;
-        case BATCH:
-            linurn = (linurn_t**) malloc(nthreads * sizeof(linurn_t*));
-            if((linurn[0] = linurn_create(ran(), nstates)) == NULL) {
-                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+            if((larrscd = (ullong*) malloc(nstates*nstates * sizeof(ullong))) == NULL) {
+                fprintf(stderr, "Not enough memory for the transition array.\n");
                 return -1;
             }
 
-            linurn_insert(linurn[0], dist);
-            for(ullong i = 1; i < nthreads; ++i) {
-                if((linurn[i] = linurn_copy(linurn[0], ran())) == NULL) {
-                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                    return -1;
+            for(ullong i = 0; i < nstates; ++i) {
+                for(ullong j = 0; j < nstates; ++j) {
+                    larrfst[i*nstates+j] = i;
+                    larrscd[i*nstates+j] = j;
                 }
             }
-            break;
-        case MBATCH:
-            bsturn = (bsturn_t**) malloc(nthreads * sizeof(bsturn_t*));
-            if((bsturn[0] = bsturn_create(ran(), nstates)) == NULL) {
-                fprintf(stderr, "Not enough memory for the urn data structure.\n");
+        }
+
+        ullong kfst, kscd, vfst, vscd;
+        ullong hfst, hscd;
+        for(ullong i = 0; i < ntrans; ++i) {
+            c = 0;
+            if(scanf("%llu:%llu %llu:%llu%c", &kfst, &kscd, &vfst, &vscd, &c) != 5 || c != '\n' ||
+                    errno != 0 || vfst == 0 || vscd == 0 || kfst == 0 || kscd == 0 ||
+                    kfst > nstates || kscd > nstates || vfst > nstates || vscd > nstates) {
+                fprintf(stderr, "Transitions must be given such that s_ij are in [1,nstates] or "
+                                "were entered invalidly.\n");
                 return -1;
             }
-
-            bsturn_insert(bsturn[0], dist);
-            for(ullong i = 1; i < nthreads; ++i) {
-                if((bsturn[i] = bsturn_copy(bsturn[0], ran())) == NULL) {
-                    fprintf(stderr, "Not enough memory for the urn data structure.\n");
-                    return -1;
+        
+            kfst--; kscd--; vfst--; vscd--;
+            if(hmap) {
+                intpmap_lookup(lmap, kfst, kscd, &hfst, &hscd);
+                if(hfst == ULLONG_MAX) {
+                    intpmap_insert(lmap, kfst, kscd, vfst, vscd);
+                    trtab_insert(ltab, kfst, kscd, vfst, vscd);
                 }
+            } else {
+                larrfst[kfst*nstates+kscd] = vfst;
+                larrscd[kfst*nstates+kscd] = vscd;
             }
-            break;
-        default:
-            abort();
-    }
-    free(dist);
-
-    // Read transitions
-    if(verbose)
-        printf("Enter the transitions as a newline separated list of two space separated state "
-               "pairs in turn separated by a colon:\n");
-
-    if(hmap) {
-        delta = hlookup;
-        if((lmap = intpmap_create(ntrans, nagents-1)) == NULL) {
-            fprintf(stderr, "Not enough memory for the transition map.\n");
-            return -1;
-        }
-    } else {
-        delta = alookup;
-        if((larrfst = (ullong*) malloc(nstates*nstates * sizeof(ullong))) == NULL) {
-            fprintf(stderr, "Not enough memory for the transition array.\n");
-            return -1;
-        }
-        if((larrscd = (ullong*) malloc(nstates*nstates * sizeof(ullong))) == NULL) {
-            fprintf(stderr, "Not enough memory for the transition array.\n");
-            return -1;
         }
 
-        for(ullong i = 0; i < nstates; ++i) {
-            for(ullong j = 0; j < nstates; ++j) {
-                larrfst[i*nstates+j] = i;
-                larrscd[i*nstates+j] = j;
-            }
+        // Only the last transition of a pair counts for the array, thus the table is filled
+        // afterwards
+        if(!hmap) {
+            for(ullong i = 0; i < nstates; ++i)
+                for(ullong j = 0; j < nstates; ++j)
+                    trtab_insert(ltab, i, j, larrfst[i*nstates+j], larrscd[i*nstates+j]);
         }
+        trtab_build(ltab);
     }
 
-    ullong kfst, kscd, vfst, vscd;
-    ullong hfst, hscd;
-    for(ullong i = 0; i < ntrans; ++i) {
-        c = 0;
-        if(scanf("%llu:%llu %llu:%llu%c", &kfst, &kscd, &vfst, &vscd, &c) != 5 || c != '\n' ||
-                errno != 0 || vfst == 0 || vscd == 0 || kfst == 0 || kscd == 0 ||
-                kfst > nstates || kscd > nstates || vfst > nstates || vscd > nstates) {
-            fprintf(stderr, "Transitions must be given such that s_ij are in [1,nstates] or were "
-                            "entered invalidly.\n");
-            return -1;
-        }
-        
-        kfst--; kscd--; vfst--; vscd--;
-        if(hmap) {
-            intpmap_lookup(lmap, kfst, kscd, &hfst, &hscd);
-            if(hfst == ULLONG_MAX)
-                intpmap_insert(lmap, kfst, kscd, vfst, vscd);
-        } else {
-            larrfst[kfst*nstates+kscd] = vfst;
-            larrscd[kfst*nstates+kscd] = vscd;
-        }
+    // The output of -o only needs the final configuration
+    if(omode != SNAPS) {
+        snapkind = EQUI;
+        nsnap    = 1;
+    }
+
+    // The parallel time schedule depends on the number of agents, thus it is created last, where a
+    // round of "rounds" is half a unit of parallel time
+    switch(snapkind) {
+        case EQUI:  snap = snap_equi (nsteps, nsnap); break;
+        case LOG:   snap = snap_log  (nsteps, nsnap); break;
+        case PTIME: snap = snap_ptime(nsteps, (alg == ROUNDS) ? 2 : nagents, sdt); break;
+        case LIST:  snap = snap_list (nsteps, slist, nslist); break;
+        default: abort();
+    }
+    if(snap == NULL) {
+        fprintf(stderr, "Not enough memory for the snapshot schedule.\n");
+        return -1;
+    }
+    nsnap = snap_nsnap(snap);
+    if(nstates >= ULLONG_MAX/(nsnap+1)) {
+        fprintf(stderr, "The number of states times the number of snapshots plus one needs to be "
+                        "smaller than 2^64-1.\n");
+        return -1;
     }
 
+    // The urns are initialized once the transitions are known, such that auto can calibrate
+    sran(time(NULL));
+    if(alg == AUTO && plan(dist, nagents) == 0)
+        return -1;
+    // The replication of -c keeps an extra urn with the initial configuration to copy from
+    ullong nurns = nthreads + (rstat != NOREP || omode != SNAPS);
+    if(create_urns(alg, nurns, dist, nagents) == 0)
+        return -1;
+    free(dist);
+
     // Allocated space for the configuration snapshots
     conf = (ullong**) malloc(nthreads * sizeof(ullong*));
     if(conf == NULL) {
@@ -414,24 +1423,95 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    // Simulation
-    if(nthreads > 1) {
-        if((threads = (pthread_t*) malloc(nthreads * sizeof(pthread_t))) == NULL) {
+    // Every thread keeps its own stop condition since the stop step is returned within
+    if(esilent || neset > 0) {
+        if((stop = (popsim_stop_t*) calloc(nthreads, sizeof(popsim_stop_t))) == NULL) {
+            fprintf(stderr, "Not enough memory for the stop conditions.\n");
+            return -1;
+        }
+        for(ullong i = 0; i < nthreads; ++i) {
+            stop[i].silent  = (esilent && karity == 2) ? ltab : NULL;
+            stop[i].ksilent = (esilent && karity > 2) ? lktab : NULL;
+            stop[i].set    = eset;
+            stop[i].nset   = neset;
+        }
+    }
+
+    // Simulation, where the lock-step simulator runs all replicas at once on this thread and -i
+    // groups ninter replicas on every thread
+    ullong nrun = (nthreads + ninter-1) / ninter;
+    if(alg == LOCKSTEP) {
+        if(popsim_lockstep(linurn, nthreads, nsteps, nstates, snap, conf, delta, stop,
+                           ran()) == 0) {
+            fprintf(stderr, "Not enough memory to run the lock-step simulator.\n");
+            return -1;
+        }
+    } else if(alg == SPLIT) {
+        split.level   = xlevel;
+        split.arg     = NULL;
+        split.nlevels = nxthresh;
+        split.ntraj   = ntraj;
+        split.nbatch  = POPSIM_MIN(ntraj, SPLIT_NBATCH);
+        split.thresh  = (ldouble*) malloc(nxthresh * sizeof(ldouble));
+        split.cond    = (ldouble*) malloc(nxthresh * sizeof(ldouble));
+        if(split.thresh == NULL || split.cond == NULL) {
+            fprintf(stderr, "Not enough memory for the levels of the splitting.\n");
+            return -1;
+        }
+        for(ullong k = 0; k < nxthresh; ++k)
+            split.thresh[k] = xthresh[k];
+        if(popsim_split(bsturn[0], nsteps, nstates, delta, stop, &split, ran()) == 0) {
+            fprintf(stderr, "Not enough memory to run the splitting.\n");
+            return -1;
+        }
+    } else if(rstat != NOREP || omode != SNAPS) {
+        if(rstat != NOREP) {
+            rres = (ldouble*) malloc(rmax * sizeof(ldouble));
+            rfin = (char*) calloc(rmax, sizeof(char));
+        }
+        threads = (pthread_t*) malloc(nthreads * sizeof(pthread_t));
+        siminfo = (siminfo_t*) malloc(nthreads * sizeof(siminfo_t));
+        if((rstat != NOREP && (rres == NULL || rfin == NULL)) || threads == NULL ||
+                siminfo == NULL) {
+            fprintf(stderr, "Not enough memory for the replication.\n");
+            return -1;
+        }
+
+        stats_init(&rstats);
+        stats_init(&ostats);
+        for(ullong i = 0; i < nthreads; ++i) {
+            siminfo[i].id = i;
+            if(i > 0)
+                pthread_create(threads+i, NULL, pthread_rep, (void*) (siminfo+i));
+        }
+        pthread_rep((void*) siminfo);
+        for(ullong i = 1; i < nthreads; ++i) {
+            if(pthread_join(threads[i], NULL) != 0) {
+                fprintf(stderr, "Threads could not be joined.\n");
+                return -1;
+            }
+        }
+        free(rres);
+        free(rfin);
+        free(siminfo);
+        free(threads);
+    } else if(nrun > 1) {
+        if((threads = (pthread_t*) malloc(nrun * sizeof(pthread_t))) == NULL) {
             fprintf(stderr, "Not enough memory for the thread states.\n");
             return -1;
         }
 
-        if((siminfo = (siminfo_t*) malloc(nthreads * sizeof(siminfo_t))) == NULL) {
+        if((siminfo = (siminfo_t*) malloc(nrun * sizeof(siminfo_t))) == NULL) {
             fprintf(stderr, "Not enough memory for the thread ids.\n");
             return -1;
         }
 
-        for(ullong i = 0; i < nthreads; ++i) {
+        for(ullong i = 0; i < nrun; ++i) {
             siminfo[i].id = i;
             siminfo[i].seed1 = ran(); siminfo[i].seed2 = ran(); siminfo[i].seed3 = ran();
             pthread_create(threads+i, NULL, pthread_sim, (void*) (siminfo+i));
         }
-        for(ullong i = 0; i < nthreads; ++i) {
+        for(ullong i = 0; i < nrun; ++i) {
             if(pthread_join(threads[i], NULL) != 0) {
                 fprintf(stderr, "Threads could not be joined.\n");
                 return -1;
@@ -446,13 +1526,24 @@ int main(int argc, char* argv[]) {
         pthread_sim((void*) &info);
     }
 
-    // Print results
-    if(nthreads > 1) {
+    // Print results, where the replicas of -o were printed as soon as they finished
+    if(rstat != NOREP || omode != SNAPS) {
+        if(omode != SNAPS)
+            print_ostats(rnext);
+        if(rstat != NOREP)
+            print_rep();
+    } else if(alg == SPLIT) {
+        print_split(&split);
+        free(split.thresh);
+        free(split.cond);
+    } else if(nthreads > 1) {
         for(ullong i = 0; i < nthreads; ++i) {
             if(verbose)
                 printf("Execution snapshots of thread %llu:\n", i+1);
             for(ullong j = 0; j < (nsnap+1); ++j)
                 print_ullong_arr(conf[i] + j*nstates, nstates);
+            if(stop != NULL)
+                print_stop(stop + i);
             if(i < nthreads-1)
                 printf("\n");
         }
@@ -461,32 +1552,27 @@ int main(int argc, char* argv[]) {
             printf("Execution snapshots:\n");
         for(ullong i = 0; i < (nsnap+1); ++i)
             print_ullong_arr(conf[0] + i*nstates, nstates);
+        if(stop != NULL)
+            print_stop(stop);
     }
 
     // Clean-Up
-    for(ullong i = 0; i < nthreads; ++i) {
+    for(ullong i = 0; i < nthreads; ++i)
         free(conf[i]);
-        switch(alg) {
-            case ARRAY:  arrurn_destroy(arrurn[i]); break;
-            case LINEAR: linurn_destroy(linurn[i]); break;
-            case BST:    bsturn_destroy(bsturn[i]); break;
-            case ALIAS:  aliurn_destroy(aliurn[i]); break;
-            case BATCH:  linurn_destroy(linurn[i]); break;
-            case MBATCH: bsturn_destroy(bsturn[i]); break;
-            default: abort();
-        }
-    }
     free(conf);
-    switch(alg) {
-        case ARRAY:  free(arrurn); break;
-        case LINEAR: free(linurn); break;
-        case BST:    free(bsturn); break;
-        case ALIAS:  free(aliurn); break;
-        case BATCH:  free(linurn); break;
-        case MBATCH: free(bsturn); break;
-        default: abort();
-    }
-    if(hmap) {
+    destroy_urns(alg, nurns);
+    if(karity > 2)
+        ktab_destroy(lktab);
+    else
+        trtab_destroy(ltab);
+    free(stop);
+    free(eset);
+    free(slist);
+    free(nlist);
+    if(inoise != NULL)
+        free(noise.target);
+    snap_destroy(snap);
+    if(hmap && karity == 2) {
         intpmap_destroy(lmap);
     } else {
         free(larrfst);
@@ -500,27 +1586,145 @@ void popsimio_printhelp(char* prog_name) {
            "in Berenbrink et al. which prints the configuration snapshots as a newline separated\n"
            "list to stdout. The configuration snapshots itself are given as a space separated list\n"
            "of integers where the position in the list corresponds to the state.\n\n"
-           "Usage: %s [-h] [-v] [-d delta] [-s nsnap] [-t nthreads] sim nsteps\n\n"
+           "Usage: %s [-h] [-v] [-c rep] [-d delta] [-e cond] [-g topo] [-i ninter] [-k k]\n"
+           "       [-l eps] [-m thresh] [-n noise] [-o out] [-p policy] [-r period]\n"
+           "       [-s sched] [-t nthreads] [-w nworkers] [-x event] sim nsteps\n\n"
            "Arguments:\n"
            "  sim         Specifies the simulator used where sim is in\n"
-           "              {\"array\",\"linear\",\"bst\",\"alias\",\"batch\",\"mbatch}.\n"
+           "              {\"array\",\"linear\",\"bst\",\"alias\",\"small\",\"lockstep\",\n"
+           "              \"skip\",\"batch\",\"mbatch\",\"pmbatch\",\"hybrid\",\"leap\",\"ode\",\n"
+           "              \"graph\",\"rounds\",\"partition\",\"split\",\"auto\"}.\n"
+           "              \"small\" is sequential and specialised for at most 16 states, where\n"
+           "              \"auto\" picks it whenever it is the fastest. \"lockstep\" runs the\n"
+           "              nthreads simulations of -t on a single thread in vectorised groups of\n"
+           "              16 and requires less than 2^31 agents. \"skip\" jumps over\n"
+           "              interactions where delta is the identity and requires less than 2^32\n"
+           "              agents. \"graph\" interacts along the edges of\n"
+           "              the graph given by -g instead of the complete graph. \"rounds\" lets\n"
+           "              all agents interact at once in every round along a uniform random\n"
+           "              perfect matching, where nsteps counts rounds and a round is half a\n"
+           "              unit of parallel time. \"hybrid\" switches between \"bst\"\n"
+           "              and \"mbatch\" depending on which one is faster. \"leap\" is\n"
+           "              approximate and neglects the collisions within every batch, whose\n"
+           "              length is controlled by -l. \"partition\" is approximate and splits\n"
+           "              the agents into nworkers partitions, see -w, which interact only\n"
+           "              within their partition and are reshuffled every period, see -r.\n"
+           "              \"split\" estimates the probability of the rare event given by -x\n"
+           "              within nsteps interactions by multilevel splitting and prints a line\n"
+           "              \"level l fraction\" for every level followed by a line\n"
+           "              \"split prob lo hi\" with the 95%% confidence interval [lo,hi].\n"
+           "              \"ode\" follows the mean-field ODE while every state is large and\n"
+           "              \"mbatch\" otherwise, see -m. \"auto\" calibrates every exact\n"
+           "              simulator on the complete graph fitting into the available memory by\n"
+           "              short runs, prints the fastest one with its predicted time and memory\n"
+           "              to stderr and runs it. If -d is not given, then \"auto\" picks\n"
+           "              \"array\" if it fits into a quarter of the memory.\n"
            "  nsteps      Amount of interaction steps that should be simulated where nsteps in\n"
            "              [1,2^64-1).\n"
            "  -h          Print this usage statement and do not run the program.\n"
            "  -v          Prompt for input and print results with messages.\n"
+           "  -c rep      Replicate the simulation until the 95%% confidence interval of the mean\n"
+           "              of a statistic is narrow enough, where rep is in {\"time:eps:nmax\",\n"
+           "              \"state:s:eps:nmax\"}. \"time\" is the stop step of -e, which is\n"
+           "              nsteps if cond did not hold, and \"state\" the final number of agents\n"
+           "              in state s in [1,nstates]. A new replica is launched whenever one of\n"
+           "              the nthreads threads of -t is free, until the half width of the\n"
+           "              interval is at most eps times the absolute mean after at least 10\n"
+           "              replicas or nmax replicas in [2,2^64-1) were launched. The replicas\n"
+           "              are accepted in the order of their launch, such that the fast ones do\n"
+           "              not bias the estimate. Instead of the snapshots, a line\n"
+           "              \"rep mean lo hi nruns reached\" is printed where reached is 1 if the\n"
+           "              interval got narrow enough and 0 otherwise. \"lockstep\", \"split\"\n"
+           "              and -i do not support -c.\n"
            "  -d delta    Specifies how the transition function is realized where delta must be\n"
            "              in {\"array\",\"map\"} where \"array\" is the default and \"array\"\n"
            "              corresponds to a two dimensional array and \"map\" to a hash map.\n"
-           "  -s nsnap    Specifies that nsnap configuration snapshots should be taken which\n"
-           "              excludes the initial and includes the final configuration where nsnap\n"
-           "              must be in [1,nsteps] and 1 is the default. The snapshots will be taken\n"
-           "              after nsteps/nsnap floored interactions and after the simulation has\n"
-           "              finished. If sim is \"batch\" or \"mbatch\" and nsteps/nsnap floored is\n"
-           "              smaller than a batched step, then this snapshot will be filled by the\n"
-           "              previous one.\n"
+           "  -e cond     Stop the simulation early once cond holds where cond is in\n"
+           "              {\"silent\",\"set:s1,s2,...\"} and may be given twice to stop once\n"
+           "              either holds. \"silent\" holds if no transition changes the\n"
+           "              configuration anymore and \"set\" if all agents are in one of the\n"
+           "              states s1,s2,... in [1,nstates]. The remaining snapshots are filled by\n"
+           "              the final configuration and a line \"stop stopped step\" is printed\n"
+           "              after the snapshots where stopped is 1 if cond held after step\n"
+           "              interactions and 0 otherwise. The batched simulators only check cond\n"
+           "              after every batch.\n"
+           "  -g topo     If sim is \"graph\", then the agents are the vertices of the interaction\n"
+           "              graph topo in {\"ring\",\"grid:rows\",\"rrg:d\"}, i.e. a ring, a torus\n"
+           "              grid of the given number of rows or a random d-regular multigraph without\n"
+           "              self loops. The graph is reordered for locality and the agents are\n"
+           "              placed on it uniformly at random.\n"
+           "  -i ninter   If sim is \"bst\", then every thread advances ninter of the nthreads\n"
+           "              simulations of -t at once and interleaves their tree descents, such\n"
+           "              that the memory latency of large numbers of states is hidden. ninter\n"
+           "              needs to be in [1,16] and 1 is the default. Every simulation stays\n"
+           "              the same as on its own thread.\n"
+           "  -k k        Lets k agents interact at once where k needs to be in [2,16] and 2 is\n"
+           "              the default. For k > 2, sim needs to be \"linear\" or \"batch\", nsteps\n"
+           "              counts k-ary interactions, delta is ignored and every transition maps\n"
+           "              a tuple of k states to k states, see below.\n"
+           "  -l eps      If sim is \"leap\", then every batch is as long as the expected change\n"
+           "              and the standard deviation of every state count stay below eps times\n"
+           "              the count where eps needs to be positive and 0.01 is the default.\n"
+           "  -m thresh   If sim is \"ode\", then the mean-field is only followed while every\n"
+           "              occupied state holds at least thresh agents and no empty state would\n"
+           "              be populated, where thresh needs to be in [1,2^64-1) and 1000 is the\n"
+           "              default.\n"
+           "  -n noise    If sim is \"batch\", \"mbatch\" or \"pmbatch\", then every interaction is\n"
+           "              corrupted with probability eps where noise is in {\"eps\",\n"
+           "              \"eps:s1,s2,...\"} and eps in [0,1]. A corrupted interaction does not\n"
+           "              apply delta, instead its initiator flips to a state drawn uniformly\n"
+           "              from s1,s2,... in [1,nstates] or from all states. Every batch is\n"
+           "              thinned at once, thus noise keeps the speed of the simulator.\n"
+           "  -o out      Print a line \"stop stopped step\" as of -e for every simulation once\n"
+           "              it finishes instead of the snapshots, preceded by its final\n"
+           "              configuration if out is \"final\", where out is in {\"stop\",\"final\"}\n"
+           "              and -e is required. A line \"stopsum nstopped nruns mean sd min max\"\n"
+           "              summarizes the steps of the nstopped of the nruns simulations that\n"
+           "              stopped at the end, where all but nruns are 0 if none stopped.\n"
+           "              Without -c, nthreads of -t is the number of simulations, which share\n"
+           "              a pool of at most one thread per processor that reuses its urn, such\n"
+           "              that millions of simulations fit into the memory. -s is ignored and\n"
+           "              \"lockstep\", \"split\" and -i do not support -o.\n"
+           "  -p policy   If sim is \"mbatch\", \"pmbatch\", \"hybrid\" or \"ode\", then policy\n"
+           "              decides on the number of collisions per epoch where policy is in\n"
+           "              {\"timed\",\"model\"} and \"timed\" is the default. \"timed\" tunes the\n"
+           "              epoch by the measured throughput and \"model\" by a cost model of the\n"
+           "              observed collisions, such that the results are reproducible for fixed\n"
+           "              seeds.\n"
+           "  -r period   If sim is \"partition\", then the agents are dealt to the partitions\n"
+           "              anew after every period units of parallel time, where period needs to\n"
+           "              be positive and 1 is the default. The smaller period, the closer the\n"
+           "              result follows the well-mixed population.\n"
+           "  -s sched    Specifies the schedule of the configuration snapshots which excludes\n"
+           "              the initial and always includes the final configuration where sched is\n"
+           "              one of the following and 1 is the default:\n"
+           "              nsnap        nsnap snapshots after every nsteps/nsnap floored\n"
+           "                           interactions where nsnap must be in [1,nsteps].\n"
+           "              log:nsnap    At most nsnap snapshots after nsteps^(j/nsnap) floored\n"
+           "                           interactions for j in [1,nsnap].\n"
+           "              ptime:dt     Snapshots after every dt units of parallel time, i.e. after\n"
+           "                           every dt*n floored interactions for n agents.\n"
+           "              list:n1,...  Snapshots after exactly n1,n2,... interactions.\n"
            "  -t nthreads Simulate the population protocol nthreads times on nthreads many threads\n"
            "              where nthreads needs to be in [1,2^64-1) and 1 is the default. The\n"
-           "              outputs are given as a newline seperated list for multiple threads.\n\n"
+           "              outputs are given as a newline seperated list for multiple threads.\n"
+           "              If sim is \"lockstep\", then all simulations share a single thread.\n"
+           "              If -c is given, then nthreads replicas run at a time.\n"
+           "              If -o is given without -c, then the simulations share a thread pool.\n"
+           "              If sim is \"split\", then nthreads is the number of trajectories per\n"
+           "              level, which are run on a single thread in 10 independent batches.\n"
+           "  -w nworkers If sim is \"pmbatch\", then the batch phase of every simulation is\n"
+           "              split among nworkers threads where nworkers needs to be in [1,2^64-1)\n"
+           "              and 1 is the default. The result has the same distribution as for\n"
+           "              \"mbatch\". If sim is \"partition\", then every simulation runs\n"
+           "              nworkers partitions on as many threads, where nworkers needs to be at\n"
+           "              most half the number of agents.\n"
+           "  -x event    If sim is \"split\", then the level of a configuration is its number of\n"
+           "              agents in the states s1,s2,... in [1,nstates] and the rare event\n"
+           "              occurs once the level reaches the last of the increasing levels\n"
+           "              l1,l2,... where event is \"s1,s2,...:l1,l2,...\". Every level is an\n"
+           "              intermediate goal from which the trajectories that reached it are\n"
+           "              cloned. -e ends a trajectory as failed.\n\n"
            "The program then expects several non-negative integers from stdin:\n"
            "  nstates     Number of states where nstates must be in [1,(2^64-1)/(nsnap+1) if delta\n"
            "              is \"map\" or in [1,min(sqrt(2^64-1),(2^64-1)/(nsnap+1)) if delta is\n"
@@ -539,7 +1743,9 @@ void popsimio_printhelp(char* prog_name) {
            "              agents must be in [2,2^64-1).\n"
            "  s_ij        Transition mapping of (s_i1,s_i2) -> (s_i3,s_i4), where s_ij must be in\n"
            "              [1,nstates] and i and j are integers in [1,ntrans] and {1,2,3,4},\n"
-           "              respectively.\n\n"
+           "              respectively. For -k, every transition maps (s_i1,...,s_ik) to\n"
+           "              (s_i(k+1),...,s_i(2k)) and is given as s_i1:...:s_ik s_i(k+1):...:s_i(2k).\n"
+           "              Only the first transition of a tuple is considered.\n\n"
            "These parameters need to be given in exactly the following format:\n"
            "nstates ndist ntrans\n"
            "s_1:a_1 s_2:a_2 ... s_ndist:a_ndist\n"
@@ -0,0 +1,103 @@
+/*
+ *      Filename: tcrn.c
+ *   Description: Test file for the chemical reaction network simulators.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "crn.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+
+#define RUNS    400
+#define NMOLEC  1000LLU
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+typedef ullong (*crnsim_t)(crn_t*, linurn_t*, snap_t*, ullong*, ullong);
+
+/*
+ *  Runs the simulator RUNS times from init and returns the mean count of species s at the j-th
+ *  snapshot.
+ */
+ldouble mean(crnsim_t sim, crn_t* c, ullong* init, snap_t* snap, ullong j, ullong s,
+             ullong seed) {
+    ullong* conf = (ullong*) malloc((snap_nsnap(snap)+1) * c->nspecies * sizeof(ullong));
+    ldouble sum = 0.L;
+    for(ullong r = 0; r < RUNS; ++r) {
+        linurn_t* u = linurn_create(seed + r, c->nspecies);
+        linurn_insert(u, init);
+        sim(c, u, snap, conf, seed + RUNS + r);
+        sum += conf[j*c->nspecies + s];
+        linurn_destroy(u);
+    }
+    free(conf);
+    return sum / RUNS;
+}
+
+/*
+ *  The decay A -> 0 with rate 1 leaves a binomial number of NMOLEC*exp(-t) molecules on average,
+ *  which both simulators have to reproduce at t = 1 within five standard errors. The dimerization
+ *  2A <-> B has to conserve A + 2B and both simulators have to agree with each other.
+ */
+int main(int argc, char** argv) {
+    ullong seed = time(NULL);
+    crnsim_t sims[2] = {crn_direct, crn_nextreaction};
+    char* names[2] = {"direct", "next reaction"};
+
+    crn_t* decay = crn_create(1, 1, 1.L);
+    crn_insert(decay, 0, CRN_NONE, CRN_NONE, CRN_NONE, 1.L);
+    crn_build(decay);
+    ullong dinit[1] = {NMOLEC};
+    snap_t* snap = snap_cequi(2.L, 2);
+
+    ldouble p = expl(-1.L);
+    ldouble se = sqrtl(NMOLEC * p * (1.L-p) / RUNS);
+    for(int k = 0; k < 2; ++k) {
+        ldouble m = mean(sims[k], decay, dinit, snap, 1, 0, seed);
+        if(fabsl(m - NMOLEC*p) < 5.L*se)
+            printf("Passed %s decay test.\n", names[k]);
+        else
+            printf("Failed %s decay test: mean %Lf, expected %Lf.\n", names[k], m, NMOLEC*p);
+    }
+    crn_destroy(decay);
+    snap_destroy(snap);
+
+    crn_t* dim = crn_create(2, 2, 100.L);
+    crn_insert(dim, 0, 0, 1, CRN_NONE, 1.L);
+    crn_insert(dim, 1, CRN_NONE, 0, 0, 0.5L);
+    crn_build(dim);
+    ullong minit[2] = {NMOLEC, 0};
+    snap = snap_cequi(1.L, 10);
+
+    ullong* conf = (ullong*) malloc((snap_nsnap(snap)+1) * 2 * sizeof(ullong));
+    int failed = 0;
+    for(int k = 0; k < 2; ++k) {
+        linurn_t* u = linurn_create(seed, 2);
+        linurn_insert(u, minit);
+        sims[k](dim, u, snap, conf, seed);
+        for(ullong j = 0; j <= snap_nsnap(snap); ++j)
+            failed |= (conf[2*j] + 2*conf[2*j+1] != NMOLEC);
+        linurn_destroy(u);
+    }
+    free(conf);
+
+    if(failed == 0)
+        printf("Passed dimerization conservation test.\n");
+    else
+        printf("Failed dimerization conservation test.\n");
+
+    ldouble md = mean(crn_direct, dim, minit, snap, 10, 1, seed);
+    ldouble mn = mean(crn_nextreaction, dim, minit, snap, 10, 1, seed + 2*RUNS);
+    if(fabsl(md - mn) < 0.05L * md)
+        printf("Passed dimerization agreement test.\n");
+    else
+        printf("Failed dimerization agreement test: %Lf and %Lf.\n", md, mn);
+
+    crn_destroy(dim);
+    snap_destroy(snap);
+}
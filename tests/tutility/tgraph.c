@@ -0,0 +1,101 @@
+/*
+ *      Filename: tgraph.c
+ *   Description: Test file for the interaction graphs.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "graph.h"
+#include "mt.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define NVERT 1000LLU
+#define ROWS  20LLU
+#define DEG   6LLU
+#define DRAWS 100000LLU
+
+typedef unsigned long long ullong;
+
+/*
+ *  Checks that every vertex has degree deg and that every arc has its reverse.
+ */
+int regular(graph_t* g, ullong deg) {
+    for(ullong v = 0; v < graph_nvert(g); ++v) {
+        if((ullong) (graph_nend(g, v) - graph_nbegin(g, v)) != deg)
+            return 0;
+        for(uint* w = graph_nbegin(g, v); w < graph_nend(g, v); ++w) {
+            int found = 0;
+            for(uint* x = graph_nbegin(g, *w); x < graph_nend(g, *w); ++x)
+                found |= (*x == v);
+            if(!found)
+                return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int failed;
+
+    errno = 0;
+    if(graph_ring(1) == NULL && errno == EDOM)
+        printf("Passed ring too small test.\n");
+    else
+        printf("Failed ring too small test.\n");
+
+    graph_t* g = graph_ring(NVERT);
+    failed = graph_nedges(g) != NVERT || !regular(g, 2);
+    failed |= graph_reorder(g) == 0 || graph_nedges(g) != NVERT || !regular(g, 2);
+    graph_destroy(g);
+
+    if(failed == 0)
+        printf("Passed ring test.\n");
+    else
+        printf("Failed ring test.\n");
+
+    g = graph_grid(ROWS, NVERT/ROWS);
+    failed = graph_nedges(g) != 2*NVERT || !regular(g, 4);
+    failed |= graph_reorder(g) == 0 || !regular(g, 4);
+
+    // Every draw has to be an edge and every vertex has to be drawn about equally often
+    mt_t mt;
+    mt_init(&mt, 1);
+    ullong* hits = (ullong*) calloc(NVERT, sizeof(ullong));
+    ullong v, w;
+    for(ullong i = 0; i < DRAWS; ++i) {
+        graph_draw(g, &mt, &v, &w);
+        int found = 0;
+        for(uint* x = graph_nbegin(g, v); x < graph_nend(g, v); ++x)
+            found |= (*x == w);
+        failed |= !found;
+        hits[v]++;
+    }
+    for(ullong u = 0; u < NVERT; ++u)
+        failed |= (hits[u] < DRAWS/NVERT/2 || hits[u] > 2*DRAWS/NVERT);
+    free(hits);
+    graph_destroy(g);
+
+    if(failed == 0)
+        printf("Passed grid and draw test.\n");
+    else
+        printf("Failed grid and draw test.\n");
+
+    // Only the dropped self loops may lower the degrees of the random regular graph
+    g = graph_rrg(NVERT, DEG, 1);
+    ullong narcs = 0;
+    failed = 0;
+    for(ullong u = 0; u < NVERT; ++u) {
+        failed |= (ullong) (graph_nend(g, u) - graph_nbegin(g, u)) > DEG;
+        narcs  += graph_nend(g, u) - graph_nbegin(g, u);
+    }
+    failed |= narcs != 2*graph_nedges(g) || graph_nedges(g) < NVERT*DEG/2 - NVERT/10;
+    graph_destroy(g);
+
+    if(failed == 0)
+        printf("Passed random regular test.\n");
+    else
+        printf("Failed random regular test.\n");
+}
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <math.h>
 #include "hgeom.h"
 #include "mt.h"
 
@@ -24,6 +25,24 @@ void print_ullong_arr(char* prefix, ullong* arr, ullong nel) {
     printf("\n");
 }
 
+/*
+ *  Accumulates the pairs of mhgeom_pairs into a dense matrix of PAIRS columns and checks that the
+ *  cells of every row come in increasing order of their columns.
+ */
+#define PAIRS 7
+ullong pmat[PAIRS*PAIRS];
+ullong plast[2];
+int    porder;
+
+void pairs_emit(ullong i, ullong j, ullong x, void* arg) {
+    if(x == 0 || (i == plast[0] && j <= plast[1] && *((int*) arg)))
+        porder = 0;
+    *((int*) arg) = 1;
+    plast[0] = i;
+    plast[1] = j;
+    pmat[i*PAIRS+j] += x;
+}
+
 void print_llong_arr(char* prefix, llong* arr, ullong nel) {
     printf("%s:", prefix);
     for(ullong i = 0; i < nel; ++i)
@@ -195,6 +214,79 @@ int main(int argc, char** argv) {
         printf("Passed left skewed edge case tests.\n");
     else
         printf("Failed left skewed edge case tests.\n");
+
+    // binom has to hit the mean within five standard errors for the inversion and BTRD, where the
+    // probabilities above one half are mirrored
+    failed = 0;
+    ullong bn[] = {1000, 1000000000000LLU, 100};
+    long double bp[] = {0.001L, 0.3L, 0.9L};
+    for(ullong c = 0; c < 3; ++c) {
+        long double dev = 0.L;
+        for(ullong i = 0; i < CALLS/10; ++i)
+            dev += binom(&mt, bn[c], bp[c]) - bn[c]*bp[c];
+        if(fabsl(dev) > 5.L*sqrtl(bn[c]*bp[c]*(1.L-bp[c])*(CALLS/10)))
+            failed = 1;
+    }
+    if(binom(&mt, 10, 0.L) != 0 || binom(&mt, 10, 1.L) != 10 || binom(&mt, 0, 0.5L) != 0)
+        failed = 1;
+
+    if(failed == 0)
+        printf("Passed binom mean and edge case tests.\n");
+    else
+        printf("Failed binom mean and edge case tests.\n");
+
+    // mbinom has to distribute all trials and leave colors of probability zero empty
+    failed = 0;
+    long double probs[4] = {0.5L, 0.L, 0.25L, 0.25L};
+    ullong mdest[4];
+    for(ullong i = 0; i < CALLS/100; ++i) {
+        mbinom(&mt, mdest, probs, 4, 1000);
+        if(mdest[0]+mdest[1]+mdest[2]+mdest[3] != 1000 || mdest[1] != 0)
+            failed = 1;
+    }
+
+    if(failed == 0)
+        printf("Passed mbinom sum test.\n");
+    else
+        printf("Failed mbinom sum test.\n");
+
+    // The pair matrix has to keep the row and column sums and every cell has to hit the mean
+    // rows[i]*cols[j]/total within five standard errors, where empty rows and columns stay empty
+    failed = 0;
+    porder = 1;
+    ullong prows[PAIRS] = {40, 0, 7, 1, 200, 3, 49};
+    ullong pcols[PAIRS] = {0, 100, 100, 50, 0, 49, 1};
+    ullong* pwork = (ullong*) malloc(mhgeom_pairs_work(PAIRS, PAIRS) * sizeof(ullong));
+    long double pdev[PAIRS*PAIRS] = {0};
+    for(ullong i = 0; i < CALLS/100; ++i) {
+        int started = 0;
+        for(ullong c = 0; c < PAIRS*PAIRS; ++c)
+            pmat[c] = 0;
+        mhgeom_pairs(&mt, prows, PAIRS, pcols, PAIRS, pwork, pairs_emit, &started);
+        for(ullong r = 0; r < PAIRS; ++r) {
+            ullong rs = 0, cs = 0;
+            for(ullong c = 0; c < PAIRS; ++c) {
+                rs += pmat[r*PAIRS+c];
+                cs += pmat[c*PAIRS+r];
+                pdev[r*PAIRS+c] += pmat[r*PAIRS+c] - prows[r]*pcols[c]/300.L;
+            }
+            if(rs != prows[r] || cs != pcols[r])
+                failed = 1;
+        }
+    }
+    for(ullong r = 0; r < PAIRS; ++r) {
+        for(ullong c = 0; c < PAIRS; ++c) {
+            long double mean = prows[r]*pcols[c]/300.L;
+            if(fabsl(pdev[r*PAIRS+c]) > 5.L*sqrtl(mean*(CALLS/100)) + 1e-9L)
+                failed = 1;
+        }
+    }
+    free(pwork);
+
+    if(failed == 0 && porder)
+        printf("Passed mhgeom_pairs sum and mean test.\n");
+    else
+        printf("Failed mhgeom_pairs sum and mean test.\n");
 }
 
 
@@ -0,0 +1,94 @@
+/*
+ *      Filename: tktab.c
+ *   Description: Test file for the sparse transition table of k-ary interactions.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "ktab.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define NSTATES 20LLU
+#define K       3LLU
+
+typedef unsigned long long ullong;
+
+/*
+ *  The triple (p,p+1,p+2) is mapped to (p+1,p+1,p+1) for every state p, where the states wrap
+ *  around. The identity transitions should not be kept, only the first of duplicate keys should
+ *  be kept and the active ones should be sorted lexicographically.
+ */
+int main(int argc, char** argv) {
+    int failed = 0;
+
+    errno = 0;
+    if(ktab_create(NSTATES, 1, 10) == NULL && errno == EDOM)
+        printf("Passed create arity too small test.\n");
+    else
+        printf("Failed create arity too small test.\n");
+
+    ktab_t* t = ktab_create(NSTATES, K, 2*NSTATES);
+    ullong key[K], val[K];
+    for(ullong p = NSTATES; p-- > 0;) {
+        for(ullong c = 0; c < K; ++c) {
+            key[c] = (p+c) % NSTATES;
+            val[c] = (p+1) % NSTATES;
+        }
+        failed |= (ktab_insert(t, key, val) == 0);
+        val[0] = p;
+        failed |= (ktab_insert(t, key, val) == 0);
+        failed |= (ktab_insert(t, key, key) == 0);
+    }
+    failed |= (ktab_build(t) == 0);
+
+    if(failed == 0 && ktab_ntrans(t) == NSTATES)
+        printf("Passed insert identity and duplicate test.\n");
+    else
+        printf("Failed insert identity and duplicate test.\n");
+
+    failed = 0;
+    for(ullong i = 0; i < ktab_ntrans(t); ++i) {
+        failed |= (ktab_key(t, i)[0] != i || ktab_key(t, i)[2] != (i+2) % NSTATES);
+        failed |= (ktab_val(t, i)[0] != (i+1) % NSTATES);
+    }
+    for(ullong p = 0; p < NSTATES; ++p) {
+        for(ullong c = 0; c < K; ++c)
+            key[c] = (p+c) % NSTATES;
+        ullong* v = ktab_lookup(t, key);
+        failed |= (v == NULL || v[2] != (p+1) % NSTATES);
+        key[2] = p;
+        failed |= (ktab_lookup(t, key) != NULL);
+    }
+
+    // The first position splits the table into single transitions and the second one empties
+    // every range but the matching one
+    ullong lo = 0, hi = NSTATES;
+    ktab_narrow(t, &lo, &hi, 0, 5);
+    failed |= (lo != 5 || hi != 6);
+    ktab_narrow(t, &lo, &hi, 1, 7);
+    failed |= (lo != hi);
+
+    if(failed == 0)
+        printf("Passed lookup and narrow test.\n");
+    else
+        printf("Failed lookup and narrow test.\n");
+
+    // Only the triples of three consecutive states are active
+    ullong dist[NSTATES] = {0};
+    dist[0] = 10;
+    dist[1] = 10;
+    failed = (ktab_silent(t, dist) == 0);
+    dist[2] = 1;
+    failed |= (ktab_silent(t, dist) != 0);
+
+    if(failed == 0)
+        printf("Passed silent test.\n");
+    else
+        printf("Failed silent test.\n");
+
+    ktab_destroy(t);
+}
@@ -0,0 +1,58 @@
+/*
+ *      Filename: tleap.c
+ *   Description: Test file for the approximate leaping simulator.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "popsim.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define NAGENTS 10000000000LLU
+#define NSTEPS  1000000LLU
+#define NSNAP   10LLU
+
+typedef unsigned long long ullong;
+
+/*
+ *  Two agents of state 0 meeting turn the responder into state 1, all other pairs are silent.
+ */
+void decay(ullong p1, ullong q1, ullong* p2, ullong* q2) {
+    *p2 = p1;
+    *q2 = (p1 == 0 && q1 == 0) ? 1 : q1;
+}
+
+/*
+ *  With almost all agents in state 1, the configuration is close to silence and the leap bound
+ *  exceeds the range of ullong. The simulation still has to reach every snapshot and conserve the
+ *  agents.
+ */
+int main(int argc, char** argv) {
+    ullong seed = time(NULL);
+    snap_t* snap = snap_equi(NSTEPS, NSNAP);
+    ullong init[2] = {2, NAGENTS-2};
+    ullong* conf = (ullong*) malloc((NSNAP+1) * 2 * sizeof(ullong));
+
+    linurn_t* u = linurn_create(seed, 2);
+    linurn_insert(u, init);
+    popsim_stop_t stop;
+    memset(&stop, 0, sizeof(stop));
+    int ok = popsim_leap(u, NSTEPS, 2, snap, conf, decay, NULL, &stop, 0.01L, seed);
+
+    int failed = !ok || stop.step != NSTEPS;
+    for(ullong j = 0; j <= NSNAP; ++j)
+        failed |= (conf[2*j] + conf[2*j+1] != NAGENTS || conf[2*j] > 2);
+
+    if(failed == 0)
+        printf("Passed near silence test.\n");
+    else
+        printf("Failed near silence test.\n");
+
+    linurn_destroy(u);
+    free(conf);
+    snap_destroy(snap);
+}
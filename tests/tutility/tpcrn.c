@@ -0,0 +1,157 @@
+/*
+ *      Filename: tpcrn.c
+ *   Description: Test file for the simulation of two protocols on common random numbers.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "popsim.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define RUNS    2000
+#define NAGENTS 20LLU
+#define NSTEPS  60LLU
+#define NSNAP   30LLU
+#define NSTATES (NSTEPS+2)
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+/*
+ *  Every interaction moves the initiator one state up, thus the sum of the states of all agents
+ *  grows by exactly one per step.
+ */
+void counter(ullong p1, ullong q1, ullong* p2, ullong* q2) {
+    *p2 = (p1+1 < NSTATES) ? p1+1 : p1;
+    *q2 = q1;
+}
+
+/*
+ *  One-way epidemic where state 1 infects state 0 and every other pair stays unchanged.
+ */
+void epidemic(ullong p1, ullong q1, ullong* p2, ullong* q2) {
+    *p2 = (p1 == 0 && q1 == 1) ? 1 : p1;
+    *q2 = (p1 == 1 && q1 == 0) ? 1 : q1;
+}
+
+trtab_t* table(void (*delta)(ullong, ullong, ullong*, ullong*)) {
+    trtab_t* t = trtab_create(NSTATES, NSTATES*NSTATES);
+    ullong p2, q2;
+    for(ullong p = 0; p < NSTATES; ++p) {
+        for(ullong q = 0; q < NSTATES; ++q) {
+            delta(p, q, &p2, &q2);
+            trtab_insert(t, p, q, p2, q2);
+        }
+    }
+    trtab_build(t);
+    return t;
+}
+
+/*
+ *  Returns the sum of the states of all agents in the configuration dist.
+ */
+ullong ssum(ullong* dist) {
+    ullong sum = 0;
+    for(ullong s = 0; s < NSTATES; ++s)
+        sum += s * dist[s];
+    return sum;
+}
+
+/*
+ *  The schedule puts a snapshot every two steps, which often equals the collision free part of a
+ *  batch in a population of NAGENTS agents. In every run, the counter lane has to be at exactly
+ *  the scheduled step in every snapshot and the run has to end at NSTEPS. The mean number of
+ *  infected agents of the epidemic lane has to agree with popsim_batch at every snapshot within
+ *  five standard errors, where the epidemic runs in either lane.
+ */
+int main(int argc, char** argv) {
+    ullong seed = time(NULL);
+    snap_t* snap = snap_equi(NSTEPS, NSNAP);
+
+    ullong init[NSTATES] = {0};
+    init[0] = NAGENTS-1;
+    init[1] = 1;
+
+    void (*delta[2])(ullong, ullong, ullong*, ullong*);
+    trtab_t* tr[2];
+    trtab_t* ctr = table(counter);
+    trtab_t* etr = table(epidemic);
+
+    ullong* conf[2];
+    conf[0] = (ullong*) malloc((NSNAP+1) * NSTATES * sizeof(ullong));
+    conf[1] = (ullong*) malloc((NSNAP+1) * NSTATES * sizeof(ullong));
+    ldouble sum[2][NSNAP+1]  = {{0.L}};
+    ldouble ssq[2][NSNAP+1]  = {{0.L}};
+    popsim_stop_t stop[2];
+    linurn_t* u[2];
+
+    int failed = 0;
+    for(ullong r = 0; r < RUNS; ++r) {
+        // The epidemic alternates between the lanes
+        ullong e = r % 2;
+        delta[e] = epidemic; delta[1-e] = counter;
+        tr[e]    = etr;      tr[1-e]    = ctr;
+
+        memset(stop, 0, sizeof(stop));
+        for(ullong a = 0; a < 2; ++a) {
+            u[a] = linurn_create(seed, NSTATES);
+            linurn_insert(u[a], init);
+        }
+        popsim_crn(u, NSTEPS, NSTATES, snap, conf, delta, tr, stop,
+                   seed + 3*r, seed + 3*r+1, seed + 3*r+2);
+
+        failed |= (stop[0].step != NSTEPS || stop[1].step != NSTEPS);
+        for(ullong j = 0; j <= NSNAP; ++j) {
+            failed |= (ssum(conf[1-e] + j*NSTATES) != 1 + ((j == 0) ? 0 : snap_step(snap, j)));
+            sum[0][j] += conf[e][j*NSTATES + 1];
+            ssq[0][j] += conf[e][j*NSTATES + 1] * conf[e][j*NSTATES + 1];
+        }
+
+        for(ullong a = 0; a < 2; ++a)
+            linurn_destroy(u[a]);
+    }
+
+    if(failed == 0)
+        printf("Passed snapshot boundary test.\n");
+    else
+        printf("Failed snapshot boundary test.\n");
+
+    for(ullong r = 0; r < RUNS; ++r) {
+        u[0] = linurn_create(seed + 5*RUNS + r, NSTATES);
+        linurn_insert(u[0], init);
+        popsim_batch(u[0], NSTEPS, NSTATES, snap, conf[0], epidemic, etr, NULL, NULL,
+                     seed + 5*RUNS + r, seed + 6*RUNS + r, seed + 7*RUNS + r);
+        for(ullong j = 0; j <= NSNAP; ++j) {
+            sum[1][j] += conf[0][j*NSTATES + 1];
+            ssq[1][j] += conf[0][j*NSTATES + 1] * conf[0][j*NSTATES + 1];
+        }
+        linurn_destroy(u[0]);
+    }
+
+    failed = 0;
+    for(ullong j = 1; j <= NSNAP; ++j) {
+        ldouble m[2], v[2];
+        for(int k = 0; k < 2; ++k) {
+            m[k] = sum[k][j] / RUNS;
+            v[k] = (ssq[k][j] / RUNS - m[k]*m[k]) / RUNS;
+        }
+        if(fabsl(m[0] - m[1]) > 5.L*sqrtl(v[0] + v[1]) + 1e-9L) {
+            printf("Snapshot %llu: mean %Lf, expected %Lf.\n", j, m[0], m[1]);
+            failed = 1;
+        }
+    }
+
+    if(failed == 0)
+        printf("Passed marginal distribution test.\n");
+    else
+        printf("Failed marginal distribution test.\n");
+
+    free(conf[0]); free(conf[1]);
+    trtab_destroy(ctr); trtab_destroy(etr);
+    snap_destroy(snap);
+}
@@ -0,0 +1,100 @@
+/*
+ *      Filename: tsnap.c
+ *   Description: Test file for the snapshot schedules.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "snap.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define NSTEPS  1000000LLU
+#define NSNAP   100LLU
+#define NAGENTS 1000LLU
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+/*
+ *  Checks that the steps of a schedule are strictly increasing, in [1,NSTEPS] and end with NSTEPS.
+ */
+int valid(snap_t* s) {
+    if(snap_nsnap(s) == 0 || snap_step(s, snap_nsnap(s)) != NSTEPS || snap_step(s, 1) == 0)
+        return 0;
+    for(ullong j = 2; j <= snap_nsnap(s); ++j)
+        if(snap_step(s, j-1) >= snap_step(s, j))
+            return 0;
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    int failed;
+
+    errno = 0;
+    if(snap_equi(NSNAP, NSNAP+1) == NULL && errno == EDOM)
+        printf("Passed equidistant nsnap too large test.\n");
+    else
+        printf("Failed equidistant nsnap too large test.\n");
+
+    snap_t* s = snap_equi(NSTEPS+1, NSNAP);
+    failed = (snap_nsnap(s) != NSNAP);
+    for(ullong j = 1; j < NSNAP; ++j)
+        failed |= (snap_step(s, j) != j*((NSTEPS+1)/NSNAP));
+    failed |= (snap_step(s, NSNAP) != NSTEPS+1);
+    snap_destroy(s);
+
+    if(failed == 0)
+        printf("Passed equidistant test.\n");
+    else
+        printf("Failed equidistant test.\n");
+
+    // The first steps of the log-spaced schedule coincide after flooring
+    s = snap_log(NSTEPS, NSNAP);
+    failed = !valid(s) || snap_nsnap(s) > NSNAP || snap_step(s, 1) != 1;
+    snap_destroy(s);
+
+    if(failed == 0)
+        printf("Passed log-spaced test.\n");
+    else
+        printf("Failed log-spaced test.\n");
+
+    s = snap_ptime(NSTEPS, NAGENTS, 2.5L);
+    failed = !valid(s) || snap_nsnap(s) != NSTEPS/(2.5L*NAGENTS);
+    for(ullong j = 1; j < snap_nsnap(s); ++j)
+        failed |= (snap_step(s, j) != j*2500);
+    snap_destroy(s);
+
+    if(failed == 0)
+        printf("Passed parallel time test.\n");
+    else
+        printf("Failed parallel time test.\n");
+
+    ullong list[] = {NSTEPS+5, 30, 0, 10, 30, 20};
+    s = snap_list(NSTEPS, list, 6);
+    failed = !valid(s) || snap_nsnap(s) != 4 || snap_step(s, 1) != 10 || snap_step(s, 2) != 20 ||
+             snap_step(s, 3) != 30;
+    snap_destroy(s);
+
+    if(failed == 0)
+        printf("Passed explicit list test.\n");
+    else
+        printf("Failed explicit list test.\n");
+
+    s = snap_cequi(2.L, 4);
+    failed = snap_nsnap(s) != 4 || snap_time(s, 1) != 0.5L || snap_time(s, 4) != 2.L;
+    snap_destroy(s);
+
+    ldouble tlist[] = {3.L, 0.75L, 0.L, 0.25L, 0.75L};
+    s = snap_clist(2.L, tlist, 5);
+    failed |= snap_nsnap(s) != 3 || snap_time(s, 1) != 0.25L || snap_time(s, 2) != 0.75L ||
+              snap_time(s, 3) != 2.L;
+    snap_destroy(s);
+
+    if(failed == 0)
+        printf("Passed continuous time test.\n");
+    else
+        printf("Failed continuous time test.\n");
+}
@@ -0,0 +1,91 @@
+/*
+ *      Filename: tstats.c
+ *   Description: Test file for the streaming summary statistics.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "stats.h"
+#include "mt.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define NOBS  100000LLU
+#define NREPS 2000LLU
+#define NCI   20LLU
+#define SHIFT 1e12L
+
+typedef unsigned long long ullong;
+typedef long double        ldouble;
+
+int main(int argc, char** argv) {
+    int failed;
+    mt_t mt;
+    mt_init(&mt, 42);
+
+    stats_t s;
+    stats_init(&s);
+    failed = stats_var(&s) != 0.L || !isinf(stats_half(&s));
+    stats_add(&s, 3.L);
+    failed |= s.mean != 3.L || stats_var(&s) != 0.L || !isinf(stats_half(&s));
+    stats_add(&s, 5.L);
+    failed |= s.mean != 4.L || stats_var(&s) != 2.L || fabsl(stats_half(&s) - 12.706L) > 1e-12L;
+
+    if(failed == 0)
+        printf("Passed small sequence test.\n");
+    else
+        printf("Failed small sequence test.\n");
+
+    // The variance of uniform integers in [0,1000) is kept although they are shifted far away
+    // from zero, where the sum of squares would cancel
+    ullong* x = (ullong*) malloc(NOBS * sizeof(ullong));
+    ldouble mean = 0.L, var = 0.L;
+    stats_init(&s);
+    for(ullong i = 0; i < NOBS; ++i) {
+        x[i] = mt_urand(&mt, 1000);
+        mean += x[i];
+        stats_add(&s, SHIFT + x[i]);
+    }
+    mean /= NOBS;
+    for(ullong i = 0; i < NOBS; ++i)
+        var += (x[i] - mean) * (x[i] - mean);
+    var /= NOBS-1;
+    free(x);
+
+    if(s.n == NOBS && fabsl(s.mean - SHIFT - mean) < 1e-3L &&
+            fabsl(stats_var(&s)/var - 1.L) < 1e-6L)
+        printf("Passed shifted variance test.\n");
+    else
+        printf("Failed shifted variance test (mean %Lf var %Lf vs %Lf).\n", s.mean - SHIFT,
+               stats_var(&s), var);
+
+    failed = stats_tquant(1) != 12.706L || stats_tquant(30) != 2.042L || stats_tquant(31) != 1.96L;
+    for(ullong df = 2; df <= 30; ++df)
+        failed |= stats_tquant(df) >= stats_tquant(df-1);
+
+    if(failed == 0)
+        printf("Passed quantile test.\n");
+    else
+        printf("Failed quantile test.\n");
+
+    // The intervals of few observations of the sum of twelve uniforms, which is close to normal,
+    // need to cover its mean six in about 95% of the repetitions
+    ullong ncover = 0;
+    for(ullong r = 0; r < NREPS; ++r) {
+        stats_init(&s);
+        for(ullong i = 0; i < NCI; ++i) {
+            ldouble y = 0.L;
+            for(ullong k = 0; k < 12; ++k)
+                y += mt_real3(&mt);
+            stats_add(&s, y);
+        }
+        ncover += fabsl(s.mean - 6.L) <= stats_half(&s);
+    }
+
+    if(fabsl(ncover / (ldouble) NREPS - 0.95L) < 0.02L)
+        printf("Passed coverage test.\n");
+    else
+        printf("Failed coverage test (%llu of %llu).\n", ncover, NREPS);
+}
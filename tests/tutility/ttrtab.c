@@ -0,0 +1,95 @@
+/*
+ *      Filename: ttrtab.c
+ *   Description: Test file for the sparse transition table.
+ *        Author: Niklas Mamtschur
+ *  Organization: Technical University of Munich (TUM)
+ */
+
+#include "trtab.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
+#include <errno.h>
+
+#define NSTATES 100LLU
+
+typedef unsigned long long ullong;
+
+/*
+ *  Every state is mapped to its successor if it meets its successor and to itself otherwise. The
+ *  identity transitions should not be kept and the active ones should be sorted by initiator and
+ *  responder.
+ */
+int main(int argc, char** argv) {
+    int failed = 0;
+
+    errno = 0;
+    if(trtab_create(ULLONG_MAX, 10) == NULL && errno == EDOM)
+        printf("Passed create nstates too large test.\n");
+    else
+        printf("Failed create nstates too large test.\n");
+
+    trtab_t* t = trtab_create(NSTATES, NSTATES);
+    for(ullong p = NSTATES; p-- > 0;) {
+        if(trtab_insert(t, p, (p+1)%NSTATES, (p+1)%NSTATES, (p+1)%NSTATES) == 0)
+            failed = 1;
+        if(trtab_insert(t, p, p, p, p) == 0)
+            failed = 1;
+    }
+    trtab_build(t);
+
+    if(failed == 0 && trtab_ntrans(t) == NSTATES)
+        printf("Passed insert identity test.\n");
+    else
+        printf("Failed insert identity test.\n");
+
+    failed = 0;
+    for(ullong p = 0; p < NSTATES; ++p) {
+        if(trtab_rend(t, p) - trtab_rbegin(t, p) != 1)
+            failed = 1;
+        for(trans_t* tr = trtab_rbegin(t, p); tr < trtab_rend(t, p); ++tr)
+            if(tr->k[0] != p || tr->k[1] != (p+1)%NSTATES || tr->v[0] != (p+1)%NSTATES)
+                failed = 1;
+    }
+
+    if(failed == 0)
+        printf("Passed row test.\n");
+    else
+        printf("Failed row test.\n");
+
+    failed = 0;
+    for(ullong q = 0; q < NSTATES; ++q) {
+        if(trtab_cend(t, q) - trtab_cbegin(t, q) != 1)
+            failed = 1;
+        for(ullong* i = trtab_cbegin(t, q); i < trtab_cend(t, q); ++i)
+            if(trtab_trans(t, *i)->k[1] != q || trtab_trans(t, *i)->k[0] != (q+NSTATES-1)%NSTATES)
+                failed = 1;
+    }
+
+    if(failed == 0)
+        printf("Passed column test.\n");
+    else
+        printf("Failed column test.\n");
+
+    // Only the pairs (p,p+1) are active, thus a single occupied state is always silent
+    ullong dist[NSTATES] = {0};
+    dist[0] = 10;
+    failed = (trtab_silent(t, dist) == 0);
+    dist[2] = 1;
+    failed |= (trtab_silent(t, dist) == 0);
+    dist[1] = 1;
+    failed |= (trtab_silent(t, dist) != 0);
+
+    if(failed == 0)
+        printf("Passed silent test.\n");
+    else
+        printf("Failed silent test.\n");
+
+    if(trtab_insert(t, 0, 2, 0, 0) == 0 && trtab_ntrans(t) == NSTATES)
+        printf("Passed full test.\n");
+    else
+        printf("Failed full test.\n");
+
+    trtab_destroy(t);
+}